@@ -3,13 +3,17 @@
 #include "pattern.h"
 #include "utils/constexpr_utils.h"
 #include "utils/flat_set.h"
-#include "utils/flat_map.h"
+#include "utils/dynamic_bitset.h"
+#include "utils/hash_map.h"
 #include "utils/argpack.h"
 
 #include <string_view>
 #include <vector>
 #include <algorithm>
 #include <optional>
+#include <utility>
+#include <array>
+#include <span>
 
 namespace lexer {
 
@@ -59,7 +63,10 @@ namespace lexer {
 
 		using state_id = size_t;
 
-		struct transition { state_id next; interval input; };
+		using op = p::op;
+		using tag_set = p::tag_set;
+
+		struct transition { state_id next; interval input; op operation = op::none; tag_set tags = 0; };
 		struct eps_transition { state_id next; };
 
 		template <typename Action>
@@ -102,6 +109,32 @@ namespace lexer {
 				return res;
 			}
 
+			template <p::pattern P>
+			static constexpr nfa from_pattern(p::with_op_<P> pattern) {
+
+				auto res = from_pattern(pattern.inner);
+
+				// the inner automaton has transitions on the inner pattern's chars only
+				for (auto& state : res.states)
+					for (auto& t : state.trans)
+						if (t.operation == op::none)
+							t.operation = pattern.operation;
+
+				return res;
+			}
+
+			template <p::pattern P>
+			static constexpr nfa from_pattern(p::tagged_<P> pattern) {
+
+				auto res = from_pattern(pattern.inner);
+
+				for (auto& state : res.states)
+					for (auto& t : state.trans)
+						t.tags |= tag_set(1 << pattern.tag);
+
+				return res;
+			}
+
 			template <p::pattern... Ps>
 			static constexpr nfa from_pattern(p::seq<Ps...> seq) {
 
@@ -258,6 +291,29 @@ namespace lexer {
 				return res;
 			}
 
+			// epsilon free position (Glushkov) automaton, one state per char position of the pattern entered only
+			// on that position's input; initial is first but there may be many finals, each gets the action
+			template <p::pattern P>
+			static constexpr nfa from_pattern_glushkov(P pattern, Action action) {
+
+				auto builder = position_builder{};
+				auto frag = builder.add_positions(pattern);
+
+				for (auto id : frag.first)
+					builder.add_follow(0, id);
+
+				nfa res;
+				res.states = std::move(builder.states);
+
+				for (auto id : frag.last)
+					res.states[id].action = action;
+
+				if (frag.nullable)
+					res.states[0].action = action;
+
+				return res;
+			}
+
 			// similar to or_ but disjoint final states, so only suitable for final mutliple pattern merge
 			template <typename Action>
 			friend constexpr auto merge_nfas(auto&& nfas) {
@@ -273,42 +329,270 @@ namespace lexer {
 				return res;
 			}
 
-			constexpr auto eps_closure(const flat_set<state_id>& state_ids) const {
+			// eps closure of every single state, the closure of a set is the union of its members' closures
+			constexpr auto eps_closures() const {
 
-				flat_set<state_id> result;
-				flat_set<state_id> current = state_ids;
-				while (!current.empty()) {
+				std::vector<dynamic_bitset> result(states.size(), dynamic_bitset(states.size()));
+				std::vector<state_id> pending;
 
-					flat_set<state_id> tmp;
-					for (auto id : current) {
-						for (auto [next] : states[id].eps_trans) {
-							if (!current.contains(next) && !result.contains(next))
-								tmp.add(next);
+				for (state_id id = 0; id != states.size(); ++id) {
+
+					auto& closure = result[id];
+					closure.add(id);
+					pending.push_back(id);
+
+					while (!pending.empty()) {
+
+						auto current = pending.back();
+						pending.pop_back();
+
+						for (auto [next] : states[current].eps_trans) {
+							if (closure.contains(next))
+								continue;
+
+							// closures of lower states are already complete
+							if (next < id) {
+								closure |= result[next];
+								continue;
+							}
+
+							closure.add(next);
+							pending.push_back(next);
 						}
 					}
-					result.add(current);
-					current = std::move(tmp);
 				}
 
 				return result;
 			}
 
-			constexpr auto move(const flat_set<state_id>& state_ids, interval input) const {
+			// the lowest action of the states the whole of str leads to, checks a single string
+			// without building a dfa
+			constexpr std::optional<Action> match(std::string_view str) const {
 
-				flat_set<state_id> result;
+				auto closures = eps_closures();
+				auto current = closures[0];
 
-				for (auto id : state_ids) {
-					const auto& state = states[id];
+				for (char c : str) {
 
-					for (auto [t_next, t_input] : state.trans)
-						if (t_input.contains(input))
-							result.add(t_next);
+					auto next = dynamic_bitset(states.size());
+					for (auto id : current)
+						for (const auto& t : states[id].trans)
+							if (t.input.contains(c))
+								next |= closures[t.next];
+
+					current = std::move(next);
 				}
 
+				std::optional<Action> result;
+				for (auto id : current)
+					if (states[id].action && (!result || *states[id].action < *result))
+						result = states[id].action;
+
 				return result;
 			}
 
 		private:
+			// positions of a subpattern, which of them can be matched first and last
+			// and whether the subpattern matches the empty string
+			struct fragment {
+
+				std::vector<state_id> first;
+				std::vector<state_id> last;
+				bool nullable = false;
+			};
+
+			struct position_builder {
+
+				// the initial state first, then one per position
+				std::vector<state> states = std::vector<state>(1);
+
+				// input of each position, the initial state has none
+				std::vector<interval> inputs = { interval{} };
+				std::vector<op> ops = { op::none };
+				std::vector<tag_set> tags = { 0 };
+
+				// of the innermost with_op_ being built
+				op current_op = op::none;
+				// of all the tagged_ being built
+				tag_set current_tags = 0;
+
+				constexpr fragment add_position(interval input) {
+
+					state_id id = states.size();
+					states.emplace_back();
+					inputs.push_back(input);
+					ops.push_back(current_op);
+					tags.push_back(current_tags);
+
+					return { .first = { id }, .last = { id } };
+				}
+
+				constexpr fragment add_positions(p::single_char pattern) {
+
+					return add_position({ pattern.ch, pattern.ch });
+				}
+
+				constexpr fragment add_positions(p::range pattern) {
+
+					return add_position({ pattern.min, pattern.max });
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::with_op_<P> pattern) {
+
+					auto outer_op = std::exchange(current_op, pattern.operation);
+					auto res = add_positions(pattern.inner);
+					current_op = outer_op;
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::tagged_<P> pattern) {
+
+					auto outer_tags = std::exchange(current_tags, tag_set(current_tags | 1 << pattern.tag));
+					auto res = add_positions(pattern.inner);
+					current_tags = outer_tags;
+
+					return res;
+				}
+
+				template <p::pattern... Ps>
+				constexpr fragment add_positions(p::seq<Ps...> seq) {
+
+					auto front = add_positions(seq.front);
+					return concat(std::move(front), add_positions(seq.last));
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::seq<P> seq) {
+
+					return add_positions(seq.last);
+				}
+
+				template <p::pattern L, p::pattern R>
+				constexpr fragment add_positions(p::or_<L, R> pattern) {
+
+					auto res = add_positions(pattern.lhs);
+					auto rhs = add_positions(pattern.rhs);
+
+					res.first.append_range(rhs.first);
+					res.last.append_range(rhs.last);
+					res.nullable = res.nullable || rhs.nullable;
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::one_or_more<P> pattern) {
+
+					auto res = add_positions(pattern.inner);
+					loop(res);
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::zero_or_one<P> pattern) {
+
+					auto res = add_positions(pattern.inner);
+					res.nullable = true;
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::zero_or_more<P> pattern) {
+
+					auto res = add_positions(pattern.inner);
+					loop(res);
+					res.nullable = true;
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::at_least_<P> pattern) {
+
+					// A{n,} is A..AA+, each copy gets its own positions
+
+					if (pattern.min == 0)
+						return add_positions(p::zero_or_more{ pattern.inner });
+
+					fragment res = { .nullable = true };
+
+					while (--pattern.min)
+						res = concat(std::move(res), add_positions(pattern.inner));
+
+					return concat(std::move(res), add_positions(p::one_or_more{ pattern.inner }));
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::at_most_<P> pattern) {
+
+					// A{,n} is A?..A?
+					compile_assert(pattern.max != 0);
+
+					fragment res = { .nullable = true };
+
+					while (pattern.max--)
+						res = concat(std::move(res), add_positions(p::zero_or_one{ pattern.inner }));
+
+					return res;
+				}
+
+				template <p::pattern P>
+				constexpr fragment add_positions(p::times_<P> pattern) {
+
+					// A{n,m} is A..A A?..A?
+					compile_assert(pattern.min <= pattern.max);
+
+					fragment res = { .nullable = true };
+
+					for (auto i = pattern.min; i--; )
+						res = concat(std::move(res), add_positions(pattern.inner));
+
+					for (auto i = pattern.max - pattern.min; i--; )
+						res = concat(std::move(res), add_positions(p::zero_or_one{ pattern.inner }));
+
+					return res;
+				}
+
+				constexpr fragment concat(fragment lhs, fragment rhs) {
+
+					for (auto from : lhs.last)
+						for (auto to : rhs.first)
+							add_follow(from, to);
+
+					if (lhs.nullable)
+						rhs.first.insert(rhs.first.begin(), lhs.first.begin(), lhs.first.end());
+					else
+						rhs.first = std::move(lhs.first);
+
+					if (rhs.nullable)
+						rhs.last.append_range(lhs.last);
+
+					rhs.nullable = lhs.nullable && rhs.nullable;
+
+					return rhs;
+				}
+
+				constexpr void loop(const fragment& frag) {
+
+					for (auto from : frag.last)
+						for (auto to : frag.first)
+							add_follow(from, to);
+				}
+
+				// entering a position is always on its own input
+				constexpr void add_follow(state_id from, state_id to) {
+
+					auto& trans = states[from].trans;
+					if (std::ranges::find(trans, to, &transition::next) == trans.end())
+						trans.push_back({ .next = to, .input = inputs[to], .operation = ops[to], .tags = tags[to] });
+				}
+			};
+
 			constexpr void join(nfa&& other) {
 
 				// merge this's final with other's initial
@@ -364,49 +648,67 @@ namespace lexer {
 			}
 		};
 
-		constexpr auto get_possible_inputs(flat_set<interval> trans_inputs) {
-
-			std::vector<interval> inputs(std::from_range, std::move(trans_inputs));
-			std::vector<interval> result;
-
-			auto find_intersects = [&](interval current) {
+		// atomic interval of a partition together with the indexes of the source intervals covering it
+		struct partition_part {
+			interval input;
+			std::vector<size_t> sources;
+		};
 
-				for (auto it = inputs.begin(); it != inputs.end(); ++it) {
-					auto other_input = *it;
+		// splits the inputs into disjoint, sorted intervals such that every input is a union of some of them,
+		// sweeps over the sorted interval ends keeping track of the inputs covering the current position
+		constexpr auto partition_inputs(const std::vector<interval>& inputs) {
 
-					auto intersect = current & other_input;
-					if (intersect.empty())
-						continue;
+			// position where an input starts (opens) or one past where it ends
+			struct event {
+				int position;
+				bool opens;
+				size_t source;
+			};
 
-					auto sum = current | other_input;
+			std::vector<event> events;
+			events.reserve(inputs.size() * 2);
+			for (size_t i = 0; i < inputs.size(); ++i) {
+				if (inputs[i].empty())
+					continue;
+				events.push_back({ .position = inputs[i].min, .opens = true, .source = i });
+				events.push_back({ .position = inputs[i].max + 1, .opens = false, .source = i });
+			}
 
-					inputs.erase(it);
+			std::ranges::sort(events, {}, &event::position);
 
-					if (auto lower = interval{ .min = sum.min, .max = intersect.min - 1 }; !lower.empty())
-						inputs.push_back(lower);
+			std::vector<partition_part> result;
+			std::vector<size_t> active;
 
-					inputs.push_back(intersect);
+			// where each open input is in active, an input closes by moving the last one into its slot
+			std::vector<size_t> slot(inputs.size());
 
-					if (auto upper = interval{ .min = intersect.max + 1, .max = sum.max }; !upper.empty())
-						inputs.push_back(upper);
+			for (size_t i = 0; i < events.size(); ) {
 
-					return;
+				auto position = events[i].position;
+				for (; i < events.size() && events[i].position == position; ++i) {
+					auto source = events[i].source;
+					if (events[i].opens) {
+						slot[source] = active.size();
+						active.push_back(source);
+					}
+					else {
+						active[slot[source]] = active.back();
+						slot[active.back()] = slot[source];
+						active.pop_back();
+					}
 				}
 
-				result.push_back(current);
-			};
-
-			while (!inputs.empty()) {
-				auto current = inputs.front();
-				inputs.erase(inputs.begin());
+				if (active.empty() || i == events.size())
+					continue;
 
-				find_intersects(current);
+				auto& part = result.emplace_back();
+				part.input = { .min = char(position), .max = char(events[i].position - 1) };
+				part.sources = active;
 			}
 
 			return result;
 		}
 
-
 		template <typename Action>
 		class dfa {
 
@@ -430,17 +732,28 @@ namespace lexer {
 				return conv.convert();
 			}
 
+			// merges equivalent states, states with different actions are never merged
+			// and states from which no action is reachable are removed
+			constexpr dfa minimize() const {
+
+				auto min = minimizer(*this);
+				return min.minimize();
+			}
+
 			constexpr state_id step(state_id id, char c) const {
-				for (auto& [next, input] : states[id].trans)
+				for (auto& [next, input, operation, tags] : states[id].trans)
 					if (input.contains(c))
 						return next;
 
 				return rejected;
 			}
 
+			// longest match, rolls back to the last accepting state, the first char is rejected if there is none
 			constexpr auto scan(const char* ptr) {
 
 				auto begin = ptr;
+				auto end = ptr; // of the last accepted lexeme
+				auto accepted = states[0].action;
 
 				size_t current = 0;
 				while (true) {
@@ -451,262 +764,375 @@ namespace lexer {
 
 					++ptr;
 					current = next;
-				}
 
-				auto lexeme = std::string_view(begin, ptr);
+					if (states[current].action) {
+						accepted = states[current].action;
+						end = ptr;
+					}
+				}
 
-				if (states[current].action)
-					return std::invoke(*states[current].action, lexeme);
+				if (accepted)
+					return std::invoke(*accepted, std::string_view(begin, end));
 
-				return std::invoke(reject_action, lexeme);
+				return std::invoke(reject_action, std::string_view(begin, begin + 1));
 			}
 
 		private:
 			struct converter {
 
-				using nfa_states = flat_set<state_id>;
-
-				struct transition {
-					nfa_states next;
-					interval input;
-				};
+				using nfa_states = dynamic_bitset;
 
 				const nfa<Action>& source;
+				std::vector<nfa_states> closures;
 
-				flat_map<nfa_states, Action> finals;
+				// indexed by dfa state id, ids are assigned in discovery order so the initial state is 0
 				std::vector<nfa_states> states;
-				flat_map<nfa_states, std::vector<transition>> trans;
+				std::vector<std::vector<transition>> trans;
+				hash_map<nfa_states, state_id> ids;
 
 				constexpr converter(const nfa<Action>& source) :
-					source(source) {}
+					source(source), closures(source.eps_closures()) {}
 
 				constexpr auto convert() {
 					build();
 					return translate();
 				}
 
-				constexpr void build() {
+				constexpr state_id get_id(nfa_states&& set) {
 
-					auto initial = source.eps_closure({ 0 });
+					auto it = ids.add({ std::move(set), states.size() });
+					if (it->second == states.size()) {
+						states.push_back(it->first);
+						trans.emplace_back();
+					}
+					return it->second;
+				}
 
-					flat_set<nfa_states> states_set = { initial };
-					std::vector<nfa_states> unmarked = { initial };
+				constexpr void build() {
 
-					while (!unmarked.empty()) {
+					get_id(nfa_states(closures[0]));
 
-						auto current = unmarked.back();
-						unmarked.pop_back();
+					for (state_id current = 0; current < states.size(); ++current) {
 
-						handle_final(current);
+						std::vector<transition> nfa_trans;
+						for (auto id : states[current])
+							nfa_trans.append_range(source.states[id].trans);
 
-						auto& current_trans = trans.add({ current, {} })->second;
+						std::vector<interval> inputs;
+						inputs.reserve(nfa_trans.size());
+						for (auto& t : nfa_trans)
+							inputs.push_back(t.input);
 
-						flat_set<interval> inputs;
-						for (auto id : current)
-							for (auto t : source.states[id].trans)
-								inputs.add(t.input);
+						for (auto& [input, sources] : partition_inputs(inputs)) {
 
-						for (auto input : get_possible_inputs(inputs)) {
+							// eps closure of the states reachable on input
+							nfa_states next(source.states.size());
+							auto operation = op::none;
+							tag_set tags = 0;
+							for (auto i : sources) {
+								next |= closures[nfa_trans[i].next];
 
-							auto next = source.eps_closure(source.move(current, input));
+								// a tag is marked if any path marks it
+								tags |= nfa_trans[i].tags;
 
-							if (!states_set.contains(next)) {
-								states_set.add(next);
-								unmarked.push_back(next);
+								// the ops don't depend on the path, as long as they don't conflict
+								if (auto other = nfa_trans[i].operation; other != op::none) {
+									compile_assert(operation == op::none || operation == other);
+									operation = other;
+								}
 							}
 
-							current_trans.push_back({ .next = next, .input = input });
+							auto next_id = get_id(std::move(next));
+							trans[current].push_back({ .next = next_id, .input = input, .operation = operation, .tags = tags });
 						}
 					}
-
-					states_set.del(initial);
-					states.push_back(std::move(initial));
-
-					states.reserve(states_set.size() + 1);
-					for (auto& state : states_set)
-						states.push_back(std::move(state));
 				}
 
 				constexpr dfa translate() {
 
 					dfa result;
+					result.states.resize(states.size());
 
-					for (auto& state : states) {
-
-						auto& dfa_state = result.states.emplace_back();
-						if (auto* action = finals.get(state))
-							dfa_state.action = *action;
-					}
+					for (state_id id = 0; id < states.size(); ++id) {
 
-					for (size_t i = 0; i < states.size(); ++i) {
+						auto& dfa_state = result.states[id];
+						dfa_state.trans = std::move(trans[id]);
 
-						auto& dfa_state = result.states[i];
-						auto& state = states[i];
-
-						for (auto& [next, input] : *trans.get(state)) {
-							for (size_t j = 0; j < states.size(); ++j) {
-								if (next == states[j]) {
-									dfa_state.trans.push_back({ .next = j, .input = input });
-									break;
-								}
+						// the lowest nfa state with an action wins
+						for (auto nfa_id : states[id]) {
+							if (auto& action = source.states[nfa_id].action) {
+								dfa_state.action = *action;
+								break;
 							}
 						}
 					}
 
 					return result;
 				}
-
-				constexpr void handle_final(const nfa_states& states) {
-
-					for (auto id : states) {
-						auto& state = source.states[id];
-						if (state.action) {
-							//compile_assert(!finals.contains(states));
-							if (finals.contains(states)) std::abort(); // hmm
-							finals.add({ states, *state.action });
-							break;
-						}
-					}
-				}
 			};
 
+			// Hopcroft's partition refinement over the common refinement of all transition intervals,
+			// an interval taken with different ops or tags counts as that many distinct inputs
 			struct minimizer {
 
+				using block_id = size_t;
+
+				struct symbol {
+					interval input;
+					op operation;
+					tag_set tags;
+				};
+
 				const dfa& source;
 
-				std::vector<flat_set<state_id>> partition;
+				// implicit state standing for rejected, moves to itself on every input
+				state_id sink;
+
+				// disjoint and sorted intervals, every transition input is a union of some of these
+				std::vector<symbol> inputs;
 
-				minimizer(const dfa& source) :
-					source(source) {
+				// predecessors[input][state] lists states moving to state on inputs[input]
+				std::vector<std::vector<std::vector<state_id>>> predecessors;
 
-					// initial partition
-					flat_map<std::optional<Action>, flat_set<state_id>> classes;
+				std::vector<std::vector<state_id>> blocks;
+				std::vector<block_id> block_of;
 
-					for (state_id id = 0; id != states.size(); ++id) {
-						auto& state = states[id];
+				constexpr minimizer(const dfa& source) :
+					source(source), sink(source.states.size()) {
 
-						classes[state.action].add(id);
+					std::vector<interval> trans_inputs;
+					std::vector<std::pair<op, tag_set>> trans_effects;
+					for (auto& state : source.states) {
+						for (auto& t : state.trans) {
+							trans_inputs.push_back(t.input);
+							trans_effects.emplace_back(t.operation, t.tags);
+						}
 					}
 
-					for (auto& [action, set] : classes)
-						partition.push_back(std::move(set));
-				}
+					for (auto& [input, sources] : partition_inputs(trans_inputs)) {
 
-				constexpr flat_set<state_id> get_class_containing(state_id state) {
-					auto it = std::ranges::find_if(partition, [&](auto& state_class) { state_class.contains(state); });
-					return *it;
-				}
+						std::vector<std::pair<op, tag_set>> effects;
+						for (auto i : sources)
+							if (std::ranges::find(effects, trans_effects[i]) == effects.end())
+								effects.push_back(trans_effects[i]);
+
+						for (auto [operation, tags] : effects)
+							inputs.push_back({ .input = input, .operation = operation, .tags = tags });
+					}
+
+					predecessors.resize(inputs.size(), std::vector<std::vector<state_id>>(sink + 1));
+					for (size_t i = 0; i < inputs.size(); ++i)
+						for (state_id id = 0; id <= sink; ++id)
+							predecessors[i][target(id, i)].push_back(id);
 
-				constexpr transition* get_transition(state_id state, interval input) {
+					// initial partition: one block per distinct action, the sink goes with the states without one
+					std::vector<std::optional<Action>> block_actions;
 
-					for (auto& trans : source.states[state].trans)
-						if (trans.input.contains(input))
-							return &trans;
+					block_of.resize(sink + 1);
+					for (state_id id = 0; id <= sink; ++id) {
 
-					return nullptr;
+						auto action = (id == sink ? std::optional<Action>{} : source.states[id].action);
+
+						auto it = std::ranges::find(block_actions, action);
+						if (it == block_actions.end()) {
+							block_actions.push_back(action);
+							blocks.emplace_back();
+							it = block_actions.end() - 1;
+						}
+
+						block_id block = it - block_actions.begin();
+						block_of[id] = block;
+						blocks[block].push_back(id);
+					}
 				}
 
-				constexpr flat_set<state_id> split(flat_set<state_id> current_class, interval input) {
+				constexpr state_id target(state_id id, size_t input) const {
 
-					flat_map<flat_set<state_id>, flat_set<state_id>> result;
+					if (id == sink)
+						return sink;
 
-					for (auto& state : current_class) {
-						transition* trans = get_transition(state, input);
-						if (!trans)
-							continue;
+					auto& [chars, operation, tags] = inputs[input];
 
-						auto state_class = get_class_containing(trans.next);
-						result[state_class].add(state);
-					}
+					for (auto& t : source.states[id].trans)
+						if (t.input.contains(chars.min))
+							return (t.operation == operation && t.tags == tags ? t.next : sink);
 
-					return result;
+					return sink;
 				}
 
-				// rong
-				constexpr void minimize() {
+				constexpr dfa minimize() {
 
-					bool split = false;
-					do {
+					std::vector<block_id> waiting;
+					for (block_id block = 0; block < blocks.size(); ++block)
+						waiting.push_back(block);
 
-						auto current_class = partition.back();
-						partition.pop_back();
+					std::vector<bool> in_preimage(sink + 1, false);
 
-						for (interval input = { 0,1 };;) { // all inputs
+					while (!waiting.empty()) {
 
-							auto new_classes = split(current_class, input);
-							if (new_classes.size() == 1)
-								continue;
+						auto splitter = blocks[waiting.back()];
+						waiting.pop_back();
+
+						for (size_t i = 0; i < inputs.size(); ++i) {
+
+							// states moving into the splitter on this input
+							std::vector<state_id> preimage;
+							for (auto id : splitter) {
+								for (auto pred : predecessors[i][id]) {
+									if (!in_preimage[pred]) {
+										in_preimage[pred] = true;
+										preimage.push_back(pred);
+									}
+								}
+							}
 
-							split = true;
-							partition.append_range(new_classes);
-							break;
+							flat_set<block_id> touched;
+							for (auto id : preimage)
+								touched.add(block_of[id]);
+
+							for (auto block : touched) {
+
+								std::vector<state_id> inside, outside;
+								for (auto id : blocks[block])
+									(in_preimage[id] ? inside : outside).push_back(id);
+
+								if (outside.empty())
+									continue;
+
+								// the smaller half becomes the new block, which is the one to queue
+								// whether or not the old block is still waiting
+								if (inside.size() > outside.size())
+									std::swap(inside, outside);
+
+								block_id added = blocks.size();
+								for (auto id : inside)
+									block_of[id] = added;
+
+								blocks[block] = std::move(outside);
+								blocks.push_back(std::move(inside));
+
+								waiting.push_back(added);
+							}
+
+							for (auto id : preimage)
+								in_preimage[id] = false;
 						}
+					}
 
-					} while (split);
+					return translate();
 				}
-			};
 
-			/*
-							std::vector<flat_set<state_id>> partition;
+				constexpr dfa translate() const {
 
-							//std::vector<flat_set<transition>> reverse_trans;
-							//reverse_trans.resize(states.size());
+					dfa result;
+					result.reject_action = source.reject_action;
 
-							for (state_id id = 0; id != states.size(); ++id) {
-								auto& state = states[id];
+					auto dead = block_of[sink];
 
-								if (state.action)
-									partition.push_back({ *state.action, id });
+					// nothing is ever accepted
+					if (block_of[0] == dead) {
+						result.states.emplace_back();
+						return result;
+					}
 
-								//for (auto& [next, input] : state.trans)
-								//	reverse_trans[next].add({ .next = id, .input = input });
-							}
+					// a state has effects if any of its transitions has an op or tags
+					auto has_effects = [&](block_id block) {
+						return std::ranges::any_of(source.states[blocks[block].front()].trans, [](const auto& t) {
+							return t.operation != op::none || t.tags != 0;
+						});
+					};
+
+					// renumber blocks keeping the initial state first and the states with effects right after it,
+					// so scanners tell them apart by a compare of the id, the sink's block is dropped
+					std::vector<state_id> new_ids(blocks.size(), rejected);
+					new_ids[block_of[0]] = 0;
+					state_id count = 1;
+					for (bool effects : { true, false })
+						for (state_id id = 0; id < sink; ++id) {
+							auto block = block_of[id];
+							if (block != dead && new_ids[block] == rejected && has_effects(block) == effects)
+								new_ids[block] = count++;
+						}
+
+					result.states.resize(count);
+
+					for (block_id block = 0; block < blocks.size(); ++block) {
+
+						if (new_ids[block] == rejected)
+							continue;
+
+						auto representative = blocks[block].front();
+						auto& state = result.states[new_ids[block]];
 
-							bool changed = false;
-							do {
-								for (int c = -128; c <= 127; ++c)
-								{
+						state.action = source.states[representative].action;
 
+						for (size_t i = 0; i < inputs.size(); ++i) {
+
+							auto next = new_ids[block_of[target(representative, i)]];
+							if (next == rejected)
+								continue;
+
+							auto [input, operation, tags] = inputs[i];
+
+							// merge with the previous interval if adjacent and going to the same state with the same op and tags
+							if (!state.trans.empty()) {
+								auto& last = state.trans.back();
+								if (last.next == next && last.operation == operation && last.tags == tags
+									&& last.input.max + 1 == input.min) {
+									last.input.max = input.max;
+									continue;
 								}
-							} while (!changed);
+							}
 
+							state.trans.push_back({ .next = next, .input = input, .operation = operation, .tags = tags });
+						}
+					}
 
-							std::vector<flat_set<state_id>> waiting = { finals, non_finals };
-							std::vector<flat_set<state_id>> partition = { finals, non_finals };
+					return result;
+				}
+			};
+		};
 
-							while (!waiting.empty()) {
+		// allocation free copy of a dfa with fixed capacity, unlike dfa it can be kept in a constexpr variable
+		// so the dfa is not rebuilt for every size and table read from it
+		template <typename Action, size_t MaxStates, size_t MaxTrans>
+		struct dfa_table {
 
-								auto a = w.back();
-								w.pop_back();
+			size_t num_states = 0;
 
-								flat_set<interval> inputs;
-								for (auto id : current)
-									for (auto t : source.states[id].trans)
-										inputs.add(t.input);
+			// transitions of state i are trans[offsets[i], offsets[i + 1])
+			std::array<size_t, MaxStates + 1> offsets = {};
+			std::array<transition, MaxTrans> trans = {};
+			std::array<std::optional<Action>, MaxStates> actions = {};
 
-								for (auto input : get_possible_inputs(reverse_inputs) {
+			static constexpr dfa_table from_dfa(const dfa<Action>& source) {
 
+				// raise the capacity if the patterns outgrow it
+				compile_assert(source.states.size() <= MaxStates);
 
-								}
+				dfa_table result;
+				result.num_states = source.states.size();
+
+				size_t count = 0;
+				for (state_id id = 0; id < result.num_states; ++id) {
+
+					auto& state = source.states[id];
+					compile_assert(count + state.trans.size() <= MaxTrans);
 
+					result.offsets[id] = count;
+					result.actions[id] = state.action;
 
-							}*/
-							//	P: = { F, Q \ F }
-							//	W: = { F, Q \ F }
-
-							//		while (W is not empty) do
-							//			choose and remove a set A from W
-							//			for each c in  do
-							//				let X be the set of states for which a transition on c leads to a state in A
-							//				for each set Y in P for which X  Y is nonempty and Y \ X is nonempty do
-							//					replace Y in P by the two sets X  Y and Y \ X
-							//					if Y is in W
-							//						replace Y in W by the same two sets
-							//					else
-							//						if | X  Y| <= |Y \ X |
-							//							add X  Y to W
-							//						else
-							//							add Y \ X to W
+					for (auto& t : state.trans)
+						result.trans[count++] = t;
+				}
+				result.offsets[result.num_states] = count;
+
+				return result;
+			}
+
+			constexpr std::span<const transition> transitions(state_id id) const {
+				return std::span(trans.data() + offsets[id], trans.data() + offsets[id + 1]);
+			}
 		};
 
 	}
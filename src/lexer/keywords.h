@@ -0,0 +1,108 @@
+#pragma once
+
+#include "utils/constexpr_utils.h"
+
+#include <array>
+#include <algorithm>
+#include <span>
+#include <string>
+#include <string_view>
+#include <bit>
+#include <cstdint>
+
+namespace lexer::scanner {
+
+	/// exact strings told apart from the other lexemes of a rule that also matches them, their host,
+	/// by a perfect hash of the length and three chars; classify() is one hash and one compare
+	template <typename RuleId, size_t NumSlots, size_t MaxLength>
+	struct keyword_table {
+
+		static_assert(std::has_single_bit(NumSlots));
+
+		struct entry {
+			std::string_view text;
+			RuleId rule;
+			RuleId host;
+		};
+
+		struct slot {
+			std::array<char, MaxLength> chars = {};
+			std::uint8_t length = 0; // 0 if the slot is free
+			RuleId rule = {};
+			RuleId host = {};
+		};
+
+		std::array<slot, NumSlots> slots = {};
+		std::uint32_t multiplier = 0;
+
+		// tries multipliers until no two entries share a slot
+		static constexpr keyword_table build(std::span<const entry> entries) {
+
+			constexpr std::uint32_t max_tries = 1 << 16;
+
+			keyword_table result;
+			result.multiplier = 0x9e3779b1;
+
+			for (std::uint32_t tries = 0; tries < max_tries; ++tries, result.multiplier += 2) {
+
+				std::array<bool, NumSlots> taken = {};
+
+				bool perfect = true;
+				for (const auto& e : entries) {
+					auto i = result.index(e.text);
+					perfect = perfect && !taken[i];
+					taken[i] = true;
+				}
+
+				if (!perfect)
+					continue;
+
+				for (const auto& e : entries) {
+					auto& s = result.slots[result.index(e.text)];
+					std::ranges::copy(e.text, s.chars.begin());
+					s.length = std::uint8_t(e.text.size());
+					s.rule = e.rule;
+					s.host = e.host;
+				}
+
+				return result;
+			}
+
+			// the keys of two entries are equal, or the table is too crowded
+			compile_assert(false);
+			return result;
+		}
+
+		/// the rule of the keyword that is lexeme if host matched one, host otherwise
+		constexpr RuleId classify(RuleId host, std::string_view lexeme) const {
+
+			if (lexeme.empty() || lexeme.size() > MaxLength)
+				return host;
+
+			const auto& s = slots[index(lexeme)];
+			if (s.host == host && s.length == lexeme.size()
+				&& std::char_traits<char>::compare(s.chars.data(), lexeme.data(), lexeme.size()) == 0)
+				return s.rule;
+
+			return host;
+		}
+
+	private:
+		static constexpr std::uint32_t key(std::string_view text) {
+
+			auto byte = [](char c) { return std::uint32_t(static_cast<unsigned char>(c)); };
+
+			return std::uint32_t(text.size()) ^ byte(text[0]) << 8 ^ byte(text[text.size() / 2]) << 16 ^ byte(text.back()) << 24;
+		}
+
+		constexpr size_t index(std::string_view text) const {
+
+			constexpr int bits = std::countr_zero(NumSlots);
+
+			if constexpr (bits == 0)
+				return 0;
+			else
+				return (key(text) * multiplier) >> (32 - bits);
+		}
+	};
+}
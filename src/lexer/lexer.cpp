@@ -2,18 +2,179 @@
 
 #include "scanner.h"
 
+#include <cassert>
+#include <limits>
+
 namespace lexer {
 
 	tk::token reject(std::string_view lexeme) {
 		return tk::error{ tk::error::unknown_token, std::string(lexeme) };
 	}
 
+	tk::token_view reject_view(std::string_view lexeme) {
+		return tk::error_view{ tk::error::unknown_token, lexeme };
+	}
+
+	// the view builder's patterns are the builder's, so both scanners are made from one dfa;
+	// the lazy patterns match numbers without effects, which takes a dfa of their own
 	static constexpr auto builder = scanner::builder<tk::token, token::custom_patterns>{ .reject_action = reject };
+	static constexpr auto view_builder = scanner::builder<tk::token_view, token::custom_patterns_view>{ .reject_action = reject_view };
+	static constexpr auto lazy_builder = scanner::builder<tk::token, token::custom_patterns_lazy>{ .reject_action = reject };
 
 	constexpr auto fsm_scanner = builder.make_scanner();
+	constexpr auto fsm_view_scanner = view_builder.make_scanner();
+	constexpr auto fsm_lazy_scanner = lazy_builder.make_scanner();
+
+	static_assert(lexer::padding >= scanner::scanner_base::padding);
+
+	// filled in after the scan so the scanner loop does not deal with spans,
+	// they start at the lexeme's begin, past the whitespace and comments the scanner skipped
+	static void set_span(auto& token, const char* source, const char* begin, const char* end, std::uint16_t file) {
+
+		token.set_span({
+			.offset = std::uint32_t(begin - source),
+			.length = std::uint32_t(end - begin),
+			.file = file
+		});
+	}
+
+	static bool fits_span(std::string_view source) {
+
+		return source.size() <= std::numeric_limits<std::uint32_t>::max();
+	}
+
+	lexer::lexer(std::string_view source, std::uint16_t file) :
+		source(source.data()), cursor(source.data()), file(file), lines(source) {
+
+		assert(source.data()[source.size()] == '\0');
+		assert(fits_span(source));
+	}
 
 	tk::token lexer::scan(const char* str) {
 
 		return fsm_scanner.scan(str);
 	}
-}
\ No newline at end of file
+
+	tk::token lexer::next() {
+
+		if (lookahead) {
+			auto result = std::move(*lookahead);
+			lookahead.reset();
+			return result;
+		}
+
+		// a default constructed lexer has no source
+		if (!cursor)
+			return tk::eof{};
+
+		auto [result, lexeme] = fsm_scanner.scan_lexeme(cursor);
+
+		// stay on the terminator
+		if (result.is<tk::eof>())
+			cursor = lexeme.data();
+
+		set_span(result, source, lexeme.data(), cursor, file);
+
+		return std::move(result);
+	}
+
+	const tk::token& lexer::peek() {
+
+		if (!lookahead)
+			lookahead = next();
+
+		return *lookahead;
+	}
+
+	line_index::location lexer::locate(const tk::token& token) {
+
+		return lines.locate(token.get_span().offset);
+	}
+
+	static auto tokenize_with(const auto& scanner, std::string_view source, std::uint16_t file) {
+
+		assert(source.data()[source.size()] == '\0');
+		assert(fits_span(source));
+
+		std::vector<typename std::remove_cvref_t<decltype(scanner)>::token_type> result;
+		result.reserve(source.size() / 4 + 1);
+
+		const char* ptr = source.data();
+		do {
+			auto [token, lexeme] = scanner.scan_lexeme(ptr);
+			set_span(result.emplace_back(std::move(token)), source.data(), lexeme.data(), ptr, file);
+		} while (!result.back().template is<tk::eof>());
+
+		// the terminator is not part of the source
+		auto& eof = result.back();
+		eof.set_span({ .offset = eof.get_span().offset, .length = 0, .file = file });
+
+		return result;
+	}
+
+	std::vector<tk::token> lexer::tokenize(std::string_view source, std::uint16_t file) {
+
+		return tokenize_with(fsm_scanner, source, file);
+	}
+
+	std::vector<tk::token_view> lexer::tokenize_view(std::string_view source, std::uint16_t file) {
+
+		return tokenize_with(fsm_view_scanner, source, file);
+	}
+
+	static void tokenize_with(const auto& scanner, std::string_view source, tk::token_buffer& out) {
+
+		assert(source.data()[source.size()] == '\0');
+		assert(fits_span(source));
+
+		out.reserve(out.size() + source.size() / 4 + 1);
+
+		const char* ptr = source.data();
+		while (true) {
+
+			auto [token, lexeme] = scanner.scan_lexeme(ptr);
+			auto begin = lexeme.data();
+
+			bool last = token.template is<tk::eof>();
+			if (last)
+				ptr = begin;
+
+			out.push(token, { .offset = std::uint32_t(begin - source.data()), .length = std::uint32_t(ptr - begin) });
+
+			if (last)
+				break;
+		}
+	}
+
+	void lexer::tokenize(std::string_view source, tk::token_buffer& out) {
+
+		if (out.number_decoding() == tk::token_buffer::decoding::lazy)
+			tokenize_with(fsm_lazy_scanner, source, out);
+		else
+			tokenize_with(fsm_scanner, source, out);
+	}
+
+	std::vector<tk::token> lexer::tokenize_bounded(std::string_view source, std::uint16_t file) {
+
+		assert(fits_span(source));
+
+		std::vector<tk::token> result;
+		result.reserve(source.size() / 4 + 1);
+
+		const char* ptr = source.data();
+		const char* end = ptr + source.size();
+		while (ptr != end) {
+			auto [token, lexeme] = fsm_scanner.scan_lexeme(ptr, end);
+
+			// only skipped lexemes were left, the end gives the eof below
+			if (lexeme.data() == end)
+				break;
+
+			set_span(result.emplace_back(std::move(token)), source.data(), lexeme.data(), ptr, file);
+		}
+
+		set_span(result.emplace_back(fsm_scanner.scan_next(ptr, end)), source.data(), end, end, file);
+
+		return result;
+	}
+}
@@ -1,13 +1,61 @@
 #pragma once
 
+#include "line_index.h"
+
 #include "token/tokens.h"
+#include "token/token_buffer.h"
+
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <cstdint>
 
 namespace lexer {
 
+	/// the source must be followed by '\0', as std::string's data() is, and be shorter than 4 GiB;
+	/// tokens get their span within it, file is put into the spans as is
 	class lexer {
 
 	public:
 
+		lexer() = default;
+
+		explicit lexer(std::string_view source, std::uint16_t file = 0);
+
 		tk::token scan(const char* str);
+
+		/// returns eof once the source is exhausted, again on every further call,
+		/// and right away if the lexer was default constructed
+		tk::token next();
+
+		const tk::token& peek();
+
+		/// where a token returned by next() starts, the first call builds the line table
+		line_index::location locate(const tk::token& token);
+
+		/// the whole source in one pass, the last token is eof
+		static std::vector<tk::token> tokenize(std::string_view source, std::uint16_t file = 0);
+
+		/// same but the tokens' text refers to source, which has to outlive them
+		static std::vector<tk::token_view> tokenize_view(std::string_view source, std::uint16_t file = 0);
+
+		/// same into parallel arrays, out's file id goes into the spans;
+		/// numeric literals are not decoded during the scan if out is lazy
+		static void tokenize(std::string_view source, tk::token_buffer& out);
+
+		/// bytes past the end of the source tokenize_bounded may read, they must be readable but can hold anything
+		static constexpr std::size_t padding = 32;
+
+		/// same as tokenize but the source needs no terminator and scanning does not stop at '\0',
+		/// so it can be a view into a larger buffer followed by at least padding bytes
+		static std::vector<tk::token> tokenize_bounded(std::string_view source, std::uint16_t file = 0);
+
+	private:
+
+		const char* source = nullptr;
+		const char* cursor = nullptr;
+		std::uint16_t file = 0;
+		std::optional<tk::token> lookahead;
+		line_index lines;
 	};
 }
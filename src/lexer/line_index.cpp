@@ -0,0 +1,92 @@
+#include "line_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEXER_LINE_INDEX_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace lexer {
+
+	namespace {
+
+		void find_line_starts_scalar(const char* begin, const char* ptr, const char* end, std::vector<std::uint32_t>& out) {
+
+			for (; ptr != end; ++ptr)
+				if (*ptr == '\n')
+					out.push_back(std::uint32_t(ptr - begin + 1));
+		}
+
+		// a set bit in mask marks a newline at base + bit index
+		void push_mask(std::uint32_t mask, std::uint32_t base, std::vector<std::uint32_t>& out) {
+
+			while (mask) {
+				out.push_back(base + std::countr_zero(mask) + 1);
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	void find_line_starts(std::string_view source, std::vector<std::uint32_t>& out) {
+
+		const char* begin = source.data();
+		const char* ptr = begin;
+		const char* end = begin + source.size();
+
+#if defined(__AVX2__)
+		const auto newline = _mm256_set1_epi8('\n');
+		for (; end - ptr >= 32; ptr += 32) {
+			auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+			auto mask = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+			push_mask(mask, std::uint32_t(ptr - begin), out);
+		}
+#elif defined(LEXER_LINE_INDEX_SSE2)
+		const auto newline = _mm_set1_epi8('\n');
+		for (; end - ptr >= 16; ptr += 16) {
+			auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+			auto mask = std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+			push_mask(mask, std::uint32_t(ptr - begin), out);
+		}
+#endif
+
+		find_line_starts_scalar(begin, ptr, end, out);
+	}
+
+	line_index::location line_index::locate(std::uint32_t offset) {
+
+		assert(offset <= source.size());
+
+		if (line_starts.empty())
+			build();
+
+		// the last line starting at or before offset
+		auto it = std::ranges::upper_bound(line_starts, offset) - 1;
+
+		return {
+			.line = std::uint32_t(it - line_starts.begin() + 1),
+			.column = offset - *it + 1
+		};
+	}
+
+	std::uint32_t line_index::line_count() {
+
+		if (line_starts.empty())
+			build();
+
+		return std::uint32_t(line_starts.size());
+	}
+
+	void line_index::build() {
+
+		// a guess of 40 bytes per line saves most reallocations
+		line_starts.reserve(source.size() / 40 + 1);
+		line_starts.push_back(0);
+
+		find_line_starts(source, line_starts);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace lexer {
+
+	/// offset -> line and column conversion for one buffer, nothing is done until the first query
+	/// which finds all the line starts in one vectorized pass, queries are binary searches after that
+	class line_index {
+
+	public:
+
+		/// both 1 based, the column counts bytes
+		struct location {
+			std::uint32_t line;
+			std::uint32_t column;
+
+			constexpr bool operator==(const location&) const = default;
+		};
+
+		line_index() = default;
+
+		explicit line_index(std::string_view source) :
+			source(source) {}
+
+		/// offsets up to source.size() inclusive
+		location locate(std::uint32_t offset);
+
+		std::uint32_t line_count();
+
+	private:
+
+		void build();
+
+		std::string_view source;
+		std::vector<std::uint32_t> line_starts; // empty until built, always starts with 0 after
+	};
+
+	/// offsets one past every '\n' in source, in order
+	void find_line_starts(std::string_view source, std::vector<std::uint32_t>& out);
+}
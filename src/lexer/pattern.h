@@ -1,10 +1,16 @@
 #pragma once
 
 #include "utils/static_string.h"
+#include "utils/constexpr_utils.h"
 
 #include <utility>
 #include <type_traits>
+#include <string>
 #include <string_view>
+#include <cstdint>
+#include <optional>
+#include <array>
+#include <limits>
 
 namespace lexer {
 
@@ -144,6 +150,96 @@ namespace lexer {
 			return zero_or_one(p);
 		}
 
+		/// operation the scanner runs on its accumulator for every char matched by a with_op_ pattern
+		enum class op : std::uint8_t {
+			none,
+			negate,        // sets the sign
+			decimal_digit, // appends the char as a decimal digit
+		};
+
+		/// tags name submatch positions, a tag_set has bit t set for tag t
+		using tag_id = std::uint8_t;
+		using tag_set = std::uint8_t;
+
+		inline constexpr size_t max_tags = 4;
+
+		/// value built by the ops along the scanned lexeme and the offsets of its tags,
+		/// actions taking it get it with the lexeme
+		struct accumulator {
+
+			std::uint64_t value = 0;
+			bool negative = false;
+			bool overflow = false; // value no longer fits
+
+			// offset + 1 of the first char matched by each tagged_, 0 if there was none
+			std::array<std::uint32_t, max_tags> tag_ends = {};
+
+			constexpr std::optional<std::uint32_t> tag(tag_id id) const {
+
+				if (!tag_ends[id])
+					return std::nullopt;
+				return tag_ends[id] - 1;
+			}
+
+			// c is at offset in the lexeme, only transitions with an op or tags need to call this
+			constexpr void apply(op operation, tag_set tags, char c, std::uint32_t offset) {
+
+				if (tags) {
+					for (tag_id id = 0; id < max_tags; ++id)
+						if ((tags >> id & 1) && !tag_ends[id])
+							tag_ends[id] = offset + 1;
+				}
+
+				switch (operation) {
+				case op::none:
+					break;
+				case op::negate:
+					negative = true;
+					break;
+				case op::decimal_digit: {
+					auto digit = std::uint64_t(c - '0');
+					overflow |= (value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10);
+					value = value * 10 + digit;
+					break;
+				}
+				}
+			}
+
+			constexpr bool operator==(const accumulator&) const = default;
+		};
+
+		/// inner pattern whose chars run operation, the innermost op wins when nested
+		template <pattern P>
+		struct with_op_ {
+
+			using is_pattern = std::true_type;
+
+			op operation;
+			P inner;
+		};
+
+		consteval auto with_op(op operation, pattern auto inner) {
+			return with_op_(operation, inner);
+		}
+
+		/// inner pattern whose match start is recorded as the tag, that is the offset of the first char
+		/// matched by it; a dfa transition shared with other patterns marks the tag for them too,
+		/// so a tag is only meaningful for the pattern owning it
+		template <pattern P>
+		struct tagged_ {
+
+			using is_pattern = std::true_type;
+
+			tag_id tag;
+			P inner;
+		};
+
+		consteval auto tagged(tag_id tag, pattern auto inner) {
+			// a tag_set has a bit for each of them
+			compile_assert(tag < max_tags);
+			return tagged_(tag, inner);
+		}
+
 		struct range {
 
 			using is_pattern = std::true_type;
@@ -191,5 +287,36 @@ namespace lexer {
 		constexpr auto alpha = alpha_lowercase | alpha_uppercase;
 		constexpr auto alpnum = alpha | digit;
 		//constexpr auto non_ascii = range('\x80', '\xFF'); // TODO unicode pattern
+
+		namespace detail {
+
+			// any other pattern matches more than one string, or none
+			constexpr bool append_exact(const auto&, std::string&) {
+				return false;
+			}
+
+			constexpr bool append_exact(single_char pattern, std::string& out) {
+				out += pattern.ch;
+				return true;
+			}
+
+			constexpr bool append_exact(const seq<>&, std::string&) {
+				return true;
+			}
+
+			template <pattern Last, pattern... Ps>
+			constexpr bool append_exact(const seq<Last, Ps...>& pattern, std::string& out) {
+				return append_exact(pattern.front, out) && append_exact(pattern.last, out);
+			}
+		}
+
+		/// the only string a sequence of single chars, as _p and char_seq make, matches
+		constexpr std::optional<std::string> exact_string(const pattern auto& p) {
+
+			std::string result;
+			if (!detail::append_exact(p, result))
+				return std::nullopt;
+			return result;
+		}
 	}
 }
@@ -10,9 +10,12 @@ namespace lexer {
 
 		namespace p = pattern;
 
+		// may also take the value the scanner accumulated along the lexeme
 		template <typename Action>
 		concept action = requires(const Action& a, std::string_view lexeme) {
 			std::invoke(a, lexeme);
+		} || requires(const Action& a, std::string_view lexeme, const p::accumulator& value) {
+			std::invoke(a, lexeme, value);
 		};
 
 		template <p::pattern P, action Action>
@@ -41,6 +44,28 @@ namespace lexer {
 			return pattern_value{ pattern, value };
 		}
 
+		// matches of a pattern >> skip are consumed by the scanner without producing a token
+		struct skip_t {};
+		inline constexpr skip_t skip;
+
+		template <p::pattern P>
+		struct pattern_skip {
+
+			P pattern;
+		};
+
+		template <p::pattern P>
+		consteval auto operator>>(const P& pattern, skip_t) {
+
+			return pattern_skip{ pattern };
+		}
+
+		template <typename T>
+		constexpr bool is_pattern_skip = false;
+
+		template <p::pattern P>
+		constexpr bool is_pattern_skip<pattern_skip<P>> = true;
+
 		template <auto... PatternActions>
 		struct pattern_action_list {};
 	}
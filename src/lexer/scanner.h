@@ -2,39 +2,362 @@
 
 #include "fsm.h"
 #include "pattern_action.h"
+#include "skip.h"
+#include "keywords.h"
 
 #include "utils/array_of_arrays.h"
+#include "utils/constexpr_utils.h"
+#include "utils/dispatch.h"
+#include "utils/dynamic_bitset.h"
 
 #include <functional>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <bit>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <tuple>
+
+// guaranteed tail calls let every dfa state jump straight to the next one's code; only clang has them,
+// with MSVC and gcc the threaded scanner runs every scan through the switch in its step()
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::musttail)
+#define LEXER_MUSTTAIL [[clang::musttail]]
+#endif
+#endif
 
 namespace lexer::scanner {
 
-	template <typename Token, size_t... NumTrans>
-	class scanner {
+	enum class backend {
+		intervals, // per state function searching the state's transition intervals
+		table,     // dense next_state[state][byte] table
+		classes,   // byte -> equivalence class map plus next_state[state][class] table
+		threaded,  // per state code generated from the dfa, threaded by tail calls with clang, else a switch
+	};
+
+	enum class construction {
+		thompson, // nfa::from_pattern, eps transitions around every subpattern
+		glushkov, // nfa::from_pattern_glushkov, eps free, one state per char position
+	};
+
+	enum class keywords {
+		in_dfa, // every exact string rule is a path of its own in the dfa
+		hashed, // exact strings a later rule also matches are left to a keyword_table run on that rule's lexemes
+	};
+
+	// Reps' memo of (state, position) pairs from which no accepting state is reachable; shared by all scans
+	// over one buffer, it keeps tokenizing the whole buffer linear however far the patterns roll back;
+	// scans with it step through self loops instead of skipping them, so every position is recorded;
+	// the lexer's tokens roll back a few chars at most, so its whole-buffer paths scan without one
+	class failure_memo {
 
 	public:
+		// positions run up to one past the terminator, where a scan that took it stands
+		failure_memo(const char* begin, const char* end, size_t num_states) :
+			begin(begin), num_states(num_states), failed((end - begin + 2) * num_states) {}
 
-		static constexpr size_t num_states = sizeof...(NumTrans);
+		bool contains(size_t state, const char* pos) const {
+			return failed.contains(index(state, pos));
+		}
 
-		using token_type = Token;
-		using action = token_type (*)(std::string_view);
+		// state entered at pos without accepting
+		void visit(size_t state, const char* pos) {
+			trail.push_back(index(state, pos));
+		}
+
+		void accept() {
+			trail.clear();
+		}
+
+		// the scan stopped, nothing visited since the last accept leads to one
+		void reject() {
+			for (auto i : trail)
+				failed.add(i);
+			trail.clear();
+		}
+
+	private:
+		size_t index(size_t state, const char* pos) const {
+			return (pos - begin) * num_states + state;
+		}
+
+		const char* begin;
+		size_t num_states;
+		dynamic_bitset failed;
+		std::vector<size_t> trail;
+	};
+
+	using pattern::accumulator;
+
+	// what taking a transition does to the accumulator besides moving
+	struct effect {
+		pattern::op operation = pattern::op::none;
+		pattern::tag_set tags = 0;
+	};
+
+	namespace detail {
+
+		// stands in for failure_memo in single scans
+		struct no_memo {
+			static constexpr bool contains(size_t, const char*) { return false; }
+			static constexpr void visit(size_t, const char*) {}
+			static constexpr void accept() {}
+			static constexpr void reject() {}
+		};
+
+		// stands in for the effects table of scanners whose dfa has no ops or tags
+		struct no_effects {};
+
+		// what the scan loop matched, rule is no_rule if the lexeme was rejected
+		template <typename RuleId>
+		struct matched {
+			RuleId rule;
+			std::string_view lexeme;
+			accumulator value;
+		};
+	}
+
+	// a token and the lexeme it was made from
+	template <typename Token>
+	struct scanned {
+		Token token;
+		std::string_view lexeme;
+	};
+
+	// longest match scan loop shared by the backends, which provide step() and the members of scanner_common;
+	// step() runs the ops of the transition it takes on the accumulator and marks its tags at the offset
+	// it is given, that of the char in the lexeme; the rule gets the value from the end of its lexeme
+	struct scanner_base {
+
+		// bounded scans may read up to this many bytes past the end of the input, which must be readable,
+		// their content does not matter; checking the end once per that many steps keeps the loop tight,
+		// and skip_in's blocks reach at most this far past it
+		static constexpr size_t padding = 32;
+
+		static_assert(padding >= skip_block);
+
+		constexpr auto scan(this const auto& self, const char* ptr) {
+
+			return self.scan_next(ptr);
+		}
+
+		constexpr auto scan(this const auto& self, const char* ptr, const char* end) {
+
+			return self.scan_next(ptr, end);
+		}
+
+		// scans the longest lexeme starting at ptr and moves ptr past it, runs until rejected
+		// and rolls back to the last accepting state; if there is none the lexeme is the first char;
+		// lexemes of ignored rules before it are skipped
+		constexpr auto scan_next(this const auto& self, const char*& ptr) {
+
+			return self.scan_lexeme(ptr).token;
+		}
+
+		// same, also gives the lexeme of the token, which starts past the skipped ones
+		constexpr auto scan_lexeme(this const auto& self, const char*& ptr) {
+
+			// backends may have their own loop for this case
+			if constexpr (requires { self.scan_threaded(ptr); }) {
+				if !consteval {
+					return self.emit(self.scan_threaded(ptr));
+				}
+			}
+
+			auto memo = detail::no_memo{};
+			return self.emit(self.template munch<false>(ptr, nullptr, memo));
+		}
+
+		auto scan_next(this const auto& self, const char*& ptr, failure_memo& memo) {
+
+			return self.emit(self.template munch<false>(ptr, nullptr, memo)).token;
+		}
+
+		// same but the input is [ptr, end) with padding readable bytes after it, no terminator needed;
+		// at the end ptr stays put and the token is the one a terminating '\0' would give,
+		// a '\0' before the end is rejected like any char no pattern starts with
+		constexpr auto scan_next(this const auto& self, const char*& ptr, const char* end) {
+
+			return self.scan_lexeme(ptr, end).token;
+		}
+
+		constexpr auto scan_lexeme(this const auto& self, const char*& ptr, const char* end) {
+
+			auto memo = detail::no_memo{};
+			return self.emit(self.template munch<true>(ptr, end, memo));
+		}
+
+	private:
+		template <typename RuleId>
+		constexpr auto emit(this const auto& self, const detail::matched<RuleId>& match) {
+
+			using self_type = std::remove_cvref_t<decltype(self)>;
+			using result_type = scanned<typename self_type::token_type>;
+
+			if (match.rule == self_type::no_rule)
+				return result_type{ std::invoke(self.reject_action, match.lexeme), match.lexeme };
+			return result_type{ self_type::rules::make_token(match.rule, match.lexeme, match.value), match.lexeme };
+		}
+
+		template <bool Bounded, typename Memo>
+		constexpr auto munch(this const auto& self, const char*& ptr, const char* bound, Memo& memo) {
+
+			using self_type = std::remove_cvref_t<decltype(self)>;
+			using result_type = detail::matched<typename self_type::rule_id>;
+
+			// steps between checks of the bound, accepts past it are ignored
+			constexpr size_t block = (Bounded ? padding : 1);
+
+			// a skipped run leaves no positions in the memo, so scans starting inside it would run it again
+			constexpr bool skips_loops = std::is_same_v<Memo, detail::no_memo>;
+
+			// until a lexeme that is not ignored
+			while (true) {
+
+				// a run an ignored rule matches whole, its lexeme would end where the run does
+				if !consteval {
+					if (self.ignored_run.count && (!Bounded || ptr < bound) && self.ignored_run.contains(*ptr))
+						ptr = skip_in(ptr, Bounded ? bound : nullptr, self.ignored_run);
+				}
+
+				// the end of the input reads as a terminating '\0'
+				if (Bounded && ptr == bound) {
+					auto value = accumulator{};
+					auto next = self.step(0, '\0', 0, value);
+					auto rule = (next == self_type::rejected ? self_type::no_rule : self.accepts[next]);
+					return result_type{ rule, std::string_view(ptr, ptr), value };
+				}
+
+				// there eof comes from the bound alone, a '\0' inside the input is an unknown char
+				if (Bounded && *ptr == '\0') {
+					++ptr;
+					return result_type{ self_type::no_rule, std::string_view(ptr - 1, ptr), accumulator{} };
+				}
+
+				auto begin = ptr;
+				auto end = ptr; // of the last accepted lexeme
+				auto accepted = self.accepts[0];
+
+				// the value when the last accepted lexeme ended
+				auto value = accumulator{};
+				auto accepted_value = value;
+
+				typename self_type::state_id current = 0;
+				bool running = true;
+				while (running && (!Bounded || ptr < bound)) {
+
+					for (size_t i = 0; i < block; ++i) {
+
+						auto next = self.step(current, *ptr, std::uint32_t(ptr - begin), value);
+						if (next == self_type::rejected) {
+							running = false;
+							break;
+						}
+
+						++ptr;
+
+						// looped once, the rest of the run is skipped without stepping
+						if (skips_loops && next == current && self.loops[current].count) {
+							if !consteval {
+								ptr = skip_in(ptr, Bounded ? bound : nullptr, self.loops[current]);
+							}
+						}
+
+						current = next;
+
+						if (memo.contains(current, ptr)) {
+							running = false;
+							break;
+						}
+
+						if (auto rule = self.accepts[current]; rule != self_type::no_rule && (!Bounded || ptr <= bound)) {
+							accepted = rule;
+							end = ptr;
+							if constexpr (self_type::has_effects)
+								accepted_value = value;
+							memo.accept();
+						}
+						else
+							memo.visit(current, ptr);
+					}
+				}
+
+				memo.reject();
+
+				if (accepted == self_type::no_rule) {
+					ptr = begin + 1;
+					return result_type{ accepted, std::string_view(begin, ptr), accumulator{} };
+				}
+
+				ptr = end;
+				if (!self_type::rules::ignored(accepted))
+					return result_type{ accepted, std::string_view(begin, end), accepted_value };
+			}
+		}
+	};
+
+	// what the backends hold besides their transitions, the builder fills it the same for all of them;
+	// the states with effects are numbered first, states from NumEffectStates on run no ops and set no tags
+	template <typename Rules, size_t NumStates, size_t NumEffectStates>
+	struct scanner_common : scanner_base {
+
+		static constexpr size_t num_states = NumStates;
+		static constexpr size_t num_effect_states = NumEffectStates;
+		static constexpr bool has_effects = NumEffectStates != 0;
+
+		using rules = Rules;
+		using token_type = Rules::token_type;
+		using rule_id = Rules::rule_id;
+		using reject_type = token_type (*)(std::string_view);
+
+		static constexpr auto no_rule = Rules::no_rule;
+
+		// the rule id each state accepts, no_rule if none; rules::make_token() turns it into the token
+		std::array<rule_id, num_states> accepts;
+
+		// makes the token of a lexeme no rule accepts, its first char
+		reject_type reject_action;
+
+		// the self_loop() of each state
+		std::array<byte_ranges, num_states> loops;
+
+		// the bytes of a run an ignored rule matches whole from a token boundary, skipped without stepping;
+		// lexemes of ignored rules are consumed without a token
+		byte_ranges ignored_run;
+	};
+
+	template <typename Rules, size_t NumEffectStates, size_t... NumTrans>
+	class scanner : public scanner_common<Rules, sizeof...(NumTrans), NumEffectStates> {
+
+	public:
 
 		using state_id = fsm::state_id;
 		using transition = fsm::transition;
 
+		static constexpr auto rejected = state_id(-1);
+
 		array_of_arrays<transition, NumTrans...> transitions;
-		std::array<action, num_states> actions;
 
-	private:
+		constexpr state_id step(state_id current, char c, std::uint32_t offset, accumulator& value) const {
 
-		static constexpr auto rejected = state_id(-1);
+			return std::invoke(move_lut[current], this, c, offset, value);
+		}
+
+	private:
 
 		template <state_id State>
-		constexpr state_id move(char c) const {
+		constexpr state_id move(char c, std::uint32_t offset, accumulator& value) const {
 
-			for (const auto& [next, input] : transitions.get<State>())
-				if (input.contains(c))
+			for (const auto& [next, input, operation, tags] : transitions.get<State>())
+				if (input.contains(c)) {
+					if constexpr (State < NumEffectStates)
+						value.apply(operation, tags, c, offset);
 					return next;
+				}
 
 			return rejected;
 		}
@@ -46,131 +369,751 @@ namespace lexer::scanner {
 			};
 		}
 
-		static constexpr auto move_lut = make_move_lut(std::make_index_sequence<num_states>{});
+		static constexpr auto move_lut = make_move_lut(std::make_index_sequence<sizeof...(NumTrans)>{});
+	};
+
+	template <typename Rules, size_t NumEffectStates, size_t NumStates>
+	class table_scanner : public scanner_common<Rules, NumStates, NumEffectStates> {
 
 	public:
 
-		constexpr token_type scan(const char* ptr) const {
+		// one past the last state is reserved for the rejected marker
+		using state_id = uint_for<NumStates>;
+
+		static constexpr auto rejected = state_id(NumStates);
+
+		std::array<std::array<state_id, 256>, NumStates> next_state;
+
+		// effects[state][byte] of the transition taken, only kept for the states with effects
+		[[no_unique_address]] std::conditional_t<NumEffectStates != 0,
+			std::array<std::array<effect, 256>, NumEffectStates>, detail::no_effects> effects;
 
-			auto begin = ptr;
+		constexpr state_id step(state_id current, char c, std::uint32_t offset, accumulator& value) const {
+
+			auto uc = static_cast<unsigned char>(c);
+			if constexpr (NumEffectStates != 0) {
+				if (current < NumEffectStates)
+					value.apply(effects[current][uc].operation, effects[current][uc].tags, c, offset);
+			}
+			return next_state[current][uc];
+		}
+	};
+
+	template <typename Rules, size_t NumEffectStates, size_t NumStates, size_t NumClasses>
+	class class_scanner : public scanner_common<Rules, NumStates, NumEffectStates> {
+
+	public:
+
+		static constexpr size_t num_classes = NumClasses;
+
+		// one past the last state is reserved for the rejected marker
+		using state_id = uint_for<NumStates>;
+		using class_id = uint_for<num_classes - 1>;
+
+		static constexpr auto rejected = state_id(NumStates);
+
+		std::array<class_id, 256> byte_class;
+		std::array<std::array<state_id, num_classes>, NumStates> next_state;
+
+		// effects[state][class] of the transition taken, they never differ within a class;
+		// only kept for the states with effects
+		[[no_unique_address]] std::conditional_t<NumEffectStates != 0,
+			std::array<std::array<effect, num_classes>, NumEffectStates>, detail::no_effects> effects;
+
+		constexpr state_id step(state_id current, char c, std::uint32_t offset, accumulator& value) const {
+
+			auto cls = byte_class[static_cast<unsigned char>(c)];
+			if constexpr (NumEffectStates != 0) {
+				if (current < NumEffectStates)
+					value.apply(effects[current][cls].operation, effects[current][cls].tags, c, offset);
+			}
+			return next_state[current][cls];
+		}
+	};
+
+	// each state is its own code with the state's transitions read from the dfa table at compile time;
+	// with guaranteed tail calls the unbounded scan jumps from state to state directly, otherwise
+	// and in the other scans step() switches on the state
+	template <typename Rules, const auto& Table, size_t NumEffectStates>
+	class threaded_scanner : public scanner_common<Rules, Table.num_states, NumEffectStates> {
+
+		using common = scanner_common<Rules, Table.num_states, NumEffectStates>;
+
+	public:
+
+		using typename common::rule_id;
+		using common::no_rule;
+
+		// one past the last state is reserved for the rejected marker
+		using state_id = uint_for<Table.num_states>;
+
+		static constexpr auto rejected = state_id(Table.num_states);
+
+		constexpr state_id step(state_id current, char c, std::uint32_t offset, accumulator& value) const {
+
+			return dispatch<Table.num_states>(current, [&]<size_t State>() { return move<State>(c, offset, value); });
+		}
+
+#ifdef LEXER_MUSTTAIL
+		detail::matched<rule_id> scan_threaded(const char*& ptr) const {
 
-			size_t current = 0;
 			while (true) {
 
-				size_t next = std::invoke(move_lut[current], this, *ptr);
-				if (next == rejected)
-					break;
+				if (this->ignored_run.count && this->ignored_run.contains(*ptr))
+					ptr = skip_in(ptr, nullptr, this->ignored_run);
+
+				auto m = match{ .begin = ptr, .end = ptr, .accepted = no_rule };
+				enter<0>(ptr, m);
+
+				if (m.accepted == no_rule) {
+					ptr = m.begin + 1;
+					return { no_rule, std::string_view(m.begin, ptr), accumulator{} };
+				}
+
+				ptr = m.end;
+				if (!Rules::ignored(m.accepted))
+					return { m.accepted, std::string_view(m.begin, m.end), m.accepted_value };
+			}
+		}
+#endif
+
+	private:
+
+		template <size_t State>
+		static constexpr size_t num_trans = Table.offsets[State + 1] - Table.offsets[State];
+
+		template <size_t State, size_t I>
+		static constexpr auto transition = Table.trans[Table.offsets[State] + I];
+
+		template <size_t State, size_t I>
+		static constexpr bool has_effect = transition<State, I>.operation != pattern::op::none || transition<State, I>.tags != 0;
+
+		// the intervals are constants, so is every test, transitions without effects don't touch the accumulator
+		template <size_t State, size_t I = 0>
+		static constexpr state_id move(char c, std::uint32_t offset, accumulator& value) {
+
+			if constexpr (I == num_trans<State>)
+				return rejected;
+			else {
+				constexpr auto t = transition<State, I>;
+
+				if (t.input.contains(c)) {
+					if constexpr (has_effect<State, I>)
+						value.apply(t.operation, t.tags, c, offset);
+					return state_id(t.next);
+				}
+				return move<State, I + 1>(c, offset, value);
+			}
+		}
+
+#ifdef LEXER_MUSTTAIL
+		// the scan in progress
+		struct match {
+			const char* begin;
+			const char* end; // of the last accepted lexeme
+			rule_id accepted;
+			accumulator value = {};
+			accumulator accepted_value = {};
+		};
+
+		// State was entered, ptr is at its next char
+		template <size_t State>
+		static void enter(const char* ptr, match& m) {
 
-				++ptr;
-				current = next;
+			// the loop ends in this state anyway
+			if constexpr (constexpr auto loop = self_loop(Table.transitions(State), State); loop.count)
+				ptr = skip_in(ptr, nullptr, loop);
+
+			if constexpr (Table.actions[State].has_value()) {
+				m.accepted = rule_id(*Table.actions[State]);
+				m.end = ptr;
+				if constexpr (NumEffectStates != 0)
+					m.accepted_value = m.value;
 			}
 
-			auto lexeme = std::string_view(begin, ptr);
+			LEXER_MUSTTAIL return leave<State, 0>(ptr, m);
+		}
+
+		// tries transition I of State and the ones after it, the scan ends if none matches
+		template <size_t State, size_t I>
+		static void leave(const char* ptr, match& m) {
 
-			return std::invoke(actions[current], lexeme);
+			if constexpr (I == num_trans<State>)
+				return;
+			else {
+				constexpr auto t = transition<State, I>;
+
+				if (t.input.contains(*ptr)) {
+					if constexpr (has_effect<State, I>)
+						m.value.apply(t.operation, t.tags, *ptr, std::uint32_t(ptr - m.begin));
+					LEXER_MUSTTAIL return enter<t.next>(ptr + 1, m);
+				}
+				LEXER_MUSTTAIL return leave<State, I + 1>(ptr, m);
+			}
 		}
+#endif
 	};
 
-	template <typename T>
-	struct has_defined_pattern : std::bool_constant<requires { T::pattern; }> {};
+	// scans input fed chunk by chunk with any of the backends, a token is emitted once the char after it
+	// is rejected, so the dfa state and the unfinished lexeme carry over to the next chunk;
+	// only the unfinished lexeme is kept between chunks, never the whole input; ignored lexemes emit nothing
+	template <typename Scanner>
+	class stream_scanner {
 
-	template <typename Token, typename CustomPatterns>
-	struct builder;
+	public:
 
-	template <typename Token, auto... CustomPatterns>
-	struct builder<Token, pattern_action_list<CustomPatterns...> > {
+		using token_type = Scanner::token_type;
 
-		using token_type = Token;
-		using action = token_type (*)(std::string_view);
+		explicit stream_scanner(const Scanner& scanner) :
+			scanner(scanner), accepted(scanner.accepts[0]) {}
 
-		action reject_action;
+		void feed(std::string_view chunk, std::vector<token_type>& out) {
 
-		constexpr auto make_scanner() const {
+			// drop what was already emitted
+			pending.erase(0, begin);
+			pos -= begin;
+			end -= begin;
+			begin = 0;
+
+			pending.append(chunk);
+
+			run(out, false);
+		}
+
+		// the input has ended, emits the rest and eof
+		void finish(std::vector<token_type>& out) {
 
-			return make_scanner_impl(
-				std::make_index_sequence<num_states>{}
-			);
+			feed(std::string_view("\0", 1), out);
+			run(out, true);
 		}
 
 	private:
-		using dfa = fsm::dfa<action>;
-		using dfa_state = fsm::dfa<action>::state;
 
-		template <auto Action>
-		static token_type invoke_action(std::string_view lexeme) {
+		void run(std::vector<token_type>& out, bool last) {
+
+			while (true) {
+
+				if (pos == pending.size()) {
+					// suspend mid-token until more input comes
+					if (!last || pos == begin)
+						return;
+				}
+				else {
+					auto next = scanner.step(current, pending[pos], std::uint32_t(pos - begin), value);
+					if (next != Scanner::rejected) {
 
-			return token_type(std::invoke(Action, lexeme));
+						++pos;
+						current = next;
+
+						if (auto rule = scanner.accepts[current]; rule != Scanner::no_rule) {
+							accepted = rule;
+							accepted_value = value;
+							end = pos;
+						}
+						continue;
+					}
+				}
+
+				emit(out);
+			}
 		}
 
-		template <auto Value>
-		static token_type return_value(std::string_view) {
+		// emits the longest accepted lexeme and rescans whatever was read past it
+		void emit(std::vector<token_type>& out) {
 
-			return token_type(Value);
+			if (accepted == Scanner::no_rule)
+				end = begin + 1;
+
+			auto lexeme = std::string_view(pending).substr(begin, end - begin);
+			if (accepted == Scanner::no_rule)
+				out.push_back(std::invoke(scanner.reject_action, lexeme));
+			else if (!Scanner::rules::ignored(accepted))
+				out.push_back(Scanner::rules::make_token(accepted, lexeme, accepted_value));
+
+			begin = pos = end;
+			current = 0;
+			accepted = scanner.accepts[0];
+			value = accepted_value = accumulator{};
 		}
 
-		template <auto Definition>
-		static constexpr auto make_nfa() {
+		const Scanner& scanner;
 
-			auto result = fsm::nfa<action>::from_pattern(Definition.pattern);
+		std::string pending;
+		size_t begin = 0; // of the current lexeme in pending
+		size_t pos = 0;   // next char to scan
+		size_t end = 0;   // of the last accepted lexeme
 
-			if constexpr (requires{ Definition.action; })
-				result.states.back().action = &invoke_action<Definition.action>;
-			else
-				result.states.back().action = &return_value<Definition.value>;
+		Scanner::state_id current = 0;
+		Scanner::rule_id accepted;
+
+		// carried over between chunks like the state
+		accumulator value;
+		accumulator accepted_value;
+	};
+
+	template <typename T>
+	struct has_defined_pattern : std::bool_constant<requires { T::pattern; }> {};
 
+	// what the dfa depends on of a custom rule, its action does not
+	template <pattern::pattern P>
+	struct rule_shape {
+		P pattern;
+		bool ignored;
+	};
+
+	// the dfa of the builtin tokens with a pattern followed by the custom rules and everything the scanners
+	// take from it; builders whose rules differ only in their tokens and actions share one instance,
+	// so the dfa is built once for all of them
+	template <typename BuiltinPatterns, construction Construction, keywords Keywords, auto... CustomRules>
+	struct automaton {
+
+		static constexpr size_t num_builtin = BuiltinPatterns::size;
+		static constexpr size_t num_rules = num_builtin + sizeof...(CustomRules);
+
+		using rule_id = uint_for<num_rules>;
+
+		static constexpr auto no_rule = rule_id(num_rules);
+
+		// no_rule included
+		static constexpr auto ignored_rules = [] {
+			auto result = std::array<bool, num_rules + 1>{};
+			auto id = num_builtin;
+			((result[id++] = CustomRules.ignored), ...);
 			return result;
+		}();
+
+		static constexpr bool ignored(rule_id id) {
+
+			return ignored_rules[id];
 		}
 
-		template <typename... Tokens>
-		static constexpr auto make_nfas(argpack<Tokens...>) {
+		using dfa = fsm::dfa<rule_id>;
+
+		static constexpr auto make_nfa(pattern::pattern auto pattern, rule_id id) {
+
+			if constexpr (Construction == construction::glushkov)
+				return fsm::nfa<rule_id>::from_pattern_glushkov(pattern, id);
+			else {
+				auto result = fsm::nfa<rule_id>::from_pattern(pattern);
+				result.states.back().action = id;
+				return result;
+			}
+		}
+
+		template <typename... Tokens, size_t... Is, size_t... Js>
+		static constexpr auto make_nfas(argpack<Tokens...>, std::index_sequence<Is...>, std::index_sequence<Js...>) {
 
 			auto result = std::vector{
-				make_nfa< (Tokens::pattern >> &return_value<Tokens{}>) >()
+				make_nfa(Tokens::pattern, rule_id(Is))
 				...,
-				make_nfa< CustomPatterns >()
+				make_nfa(CustomRules.pattern, rule_id(num_builtin + Js))
 				...
 			};
 			return result;
 		}
 
+		static constexpr auto make_all_nfas() {
+
+			return make_nfas(BuiltinPatterns{}, BuiltinPatterns::index_sequence, std::make_index_sequence<sizeof...(CustomRules)>{});
+		}
+
+		template <typename... Tokens>
+		static constexpr auto make_exact_strings(argpack<Tokens...>) {
+
+			return std::vector<std::optional<std::string>>{
+				pattern::exact_string(Tokens::pattern)
+				...,
+				pattern::exact_string(CustomRules.pattern)
+				...
+			};
+		}
+
+		// for each rule the rule whose lexemes it is told apart from by the keyword table, no_rule if it is
+		// in the dfa; an exact string can be left out if the lowest other rule matching it comes after it
+		// and is not ignored, the dfa picks that rule for the string and the table gives it back
+		static constexpr auto make_hosts() {
+
+			auto result = std::array<rule_id, num_rules>{};
+			result.fill(no_rule);
+
+			if constexpr (Keywords == keywords::hashed) {
+
+				auto strings = make_exact_strings(BuiltinPatterns{});
+				auto nfas = make_all_nfas();
+
+				// exact strings never match each other, only the other rules can host them
+				std::vector<fsm::nfa<rule_id>> others;
+				for (size_t id = 0; id < num_rules; ++id)
+					if (!strings[id] || ignored(rule_id(id)))
+						others.push_back(std::move(nfas[id]));
+
+				auto merged = merge_nfas<rule_id>(std::move(others));
+
+				for (size_t id = 0; id < num_rules; ++id) {
+
+					if (!strings[id] || ignored(rule_id(id)))
+						continue;
+
+					auto host = merged.match(*strings[id]);
+					if (host && *host > id && !ignored(*host))
+						result[id] = *host;
+				}
+			}
+
+			return result;
+		}
+
+		static constexpr auto hosts = make_hosts();
+
 		static constexpr auto make_dfa() {
 
-			using builtin_patterns = typename token_type::token_list::template filter<has_defined_pattern>;
+			auto nfas = make_all_nfas();
 
-			auto merged = merge_nfas<action>(make_nfas(builtin_patterns{}));
+			std::vector<fsm::nfa<rule_id>> kept;
+			for (size_t id = 0; id < num_rules; ++id)
+				if (hosts[id] == no_rule)
+					kept.push_back(std::move(nfas[id]));
 
-			auto dfa = dfa::from_nfa(merged);
+			auto merged = merge_nfas<rule_id>(std::move(kept));
+
+			auto dfa = dfa::from_nfa(merged).minimize();
 
 			return dfa;
 		}
 
+		static constexpr size_t count_keywords() {
+
+			return size_t(std::ranges::count_if(hosts, [](auto host) { return host != no_rule; }));
+		}
+
+		static constexpr size_t max_keyword_length() {
+
+			auto strings = make_exact_strings(BuiltinPatterns{});
+
+			size_t result = 1;
+			for (size_t id = 0; id < num_rules; ++id)
+				if (hosts[id] != no_rule)
+					result = std::max(result, strings[id]->size());
+
+			return result;
+		}
+
+		static constexpr size_t num_keywords = count_keywords();
+
+		static constexpr auto make_keyword_table() {
+
+			// at most half full, which makes a perfect multiplier quick to find
+			using table_type = keyword_table<rule_id, std::bit_ceil(2 * num_keywords), max_keyword_length()>;
+
+			auto strings = make_exact_strings(BuiltinPatterns{});
+
+			std::vector<typename table_type::entry> entries;
+			for (size_t id = 0; id < num_rules; ++id)
+				if (hosts[id] != no_rule)
+					entries.push_back({ .text = *strings[id], .rule = rule_id(id), .host = hosts[id] });
+
+			return table_type::build(entries);
+		}
+
+		static constexpr auto keyword_lookup = make_keyword_table();
+
+		static constexpr auto make_hosts_keywords() {
+
+			auto result = std::array<bool, num_rules + 1>{};
+			for (auto host : hosts)
+				if (host != no_rule)
+					result[host] = true;
+
+			return result;
+		}
+
+		// no_rule included
+		static constexpr auto hosts_keywords = make_hosts_keywords();
+
+		// states and transitions of the dfa, the table holds exactly these
+		static constexpr auto dfa_size = [] {
+			auto dfa = make_dfa();
+			size_t num_trans = 0;
+			for (const auto& state : dfa.states)
+				num_trans += state.trans.size();
+			return std::array{ dfa.states.size(), num_trans };
+		}();
+
+		using dfa_table = fsm::dfa_table<rule_id, dfa_size[0], dfa_size[1]>;
+
+		// the dfa is built once more to fill the table, everything below reads the table
+		static constexpr auto table = dfa_table::from_dfa(make_dfa());
+
 		template <size_t... Is>
 		static constexpr auto get_num_trans(std::index_sequence<Is...>) {
 
-			auto dfa = make_dfa();
-			return std::array{ dfa.states[Is].trans.size()... };
+			return std::array{ table.transitions(Is).size()... };
+		}
+
+		// bytes are equivalent if no transition interval of any state separates them,
+		// classes are numbered in char order
+		static constexpr auto make_byte_classes() {
+
+			constexpr int char_min = std::numeric_limits<char>::min();
+			constexpr int char_max = std::numeric_limits<char>::max();
+
+			// boundary[c - char_min] is set if a new class starts at c
+			std::array<bool, 256> boundary = {};
+			for (const auto& [next, input, operation, tags] : std::span(table.trans.data(), table.offsets[table.num_states])) {
+				boundary[input.min - char_min] = true;
+				if (input.max != char_max)
+					boundary[input.max + 1 - char_min] = true;
+			}
+
+			std::array<uint8_t, 256> result = {};
+
+			int current = 0;
+			for (int c = char_min; c <= char_max; ++c) {
+				if (boundary[c - char_min] && c != char_min)
+					++current;
+				result[static_cast<unsigned char>(c)] = uint8_t(current);
+			}
+
+			return result;
+		}
+
+		// minimize() numbers the states with effects first, the count ends at the last of them
+		static constexpr size_t make_num_effect_states() {
+
+			size_t result = 0;
+			for (size_t id = 0; id < table.num_states; ++id)
+				if (std::ranges::any_of(table.transitions(id), [](const auto& t) { return t.operation != pattern::op::none || t.tags != 0; }))
+					result = id + 1;
+
+			return result;
+		}
+
+		template <size_t... Is>
+		static constexpr auto make_loops(std::index_sequence<Is...>) {
+
+			return std::array{ self_loop(table.transitions(Is), Is)... };
 		}
 
-		static constexpr size_t num_states = make_dfa().states.size();
+		// the loop of a state accepting an ignored rule, if state 0 enters it on exactly the bytes it loops on
+		// and it has no other transitions, so its lexemes are whole runs of them
+		static constexpr byte_ranges make_ignored_run() {
+
+			constexpr int char_min = std::numeric_limits<char>::min();
+			constexpr int char_max = std::numeric_limits<char>::max();
+
+			for (const auto& t : table.transitions(0)) {
+
+				auto run = loops[t.next];
+				auto rule = table.actions[t.next];
+				if (!run.count || !rule || !ignored(*rule) || table.transitions(t.next).size() != run.count)
+					continue;
+
+				bool enters_on_run = true;
+				for (int c = char_min; c <= char_max; ++c) {
+					bool enters = std::ranges::any_of(table.transitions(0), [&](const auto& u) {
+						return u.next == t.next && u.input.contains(char(c)) && u.operation == pattern::op::none && u.tags == 0;
+					});
+					enters_on_run = enters_on_run && enters == run.contains(char(c));
+				}
+
+				if (enters_on_run)
+					return run;
+			}
+
+			return {};
+		}
+
+		// the scan loop would skip them forever
+		static_assert(!table.actions[0] || !ignored(*table.actions[0]), "ignored patterns must not match the empty string");
+
+		static constexpr size_t num_states = table.num_states;
+		static constexpr size_t num_effect_states = make_num_effect_states();
+		static constexpr auto loops = make_loops(std::make_index_sequence<num_states>{});
+		static constexpr auto ignored_run = make_ignored_run();
 		static constexpr auto num_trans = get_num_trans(std::make_index_sequence<num_states>{});
+		static constexpr auto byte_classes = make_byte_classes();
+		static constexpr size_t num_classes = *std::ranges::max_element(byte_classes) + 1;
+	};
+
+	template <typename Token, typename CustomPatterns,
+		construction Construction = construction::thompson, keywords Keywords = keywords::in_dfa>
+	struct builder;
+
+	template <typename Token, auto... CustomPatterns, construction Construction, keywords Keywords>
+	struct builder<Token, pattern_action_list<CustomPatterns...>, Construction, Keywords> {
+
+		using token_type = Token;
+		using reject_type = token_type (*)(std::string_view);
+
+	private:
+		using builtin_patterns = typename token_type::token_list::template filter<has_defined_pattern>;
+
+		static constexpr auto custom_patterns = std::tuple{ CustomPatterns... };
+
+		// shared with every builder whose patterns are these, whatever their tokens and actions
+		using automaton_type = automaton<builtin_patterns, Construction, Keywords,
+			rule_shape{ CustomPatterns.pattern, is_pattern_skip<std::remove_cvref_t<decltype(CustomPatterns)>> }...>;
+
+	public:
+		// rule ids are the builtin tokens with a pattern followed by the custom patterns,
+		// on a tie the lowest id wins
+		struct rules {
+
+			using token_type = Token;
+
+			static constexpr size_t num_builtin = automaton_type::num_builtin;
+			static constexpr size_t num_rules = automaton_type::num_rules;
+
+			using rule_id = automaton_type::rule_id;
+
+			static constexpr auto no_rule = automaton_type::no_rule;
+
+			// the lexemes of these are consumed without a token
+			static constexpr bool ignored(rule_id id) {
+
+				return automaton_type::ignored(id);
+			}
+
+			// builds the token of rule Id, fixed tokens and values are constructed in place
+			template <size_t Id>
+			static token_type make(std::string_view lexeme, const accumulator& value) {
+
+				if constexpr (Id < num_builtin)
+					return token_type(typename builtin_patterns::template element<Id>{});
+				else {
+					constexpr auto& definition = std::get<Id - num_builtin>(custom_patterns);
+
+					if constexpr (automaton_type::ignored_rules[Id])
+						std::unreachable();
+					else if constexpr (!requires { definition.action; })
+						return token_type(definition.value);
+					else if constexpr (std::is_invocable_v<decltype(definition.action), std::string_view, const accumulator&>)
+						return token_type(std::invoke(definition.action, lexeme, value));
+					else
+						return token_type(std::invoke(definition.action, lexeme));
+				}
+			}
+
+			// a switch over the ids in place of a call through a per rule pointer;
+			// the "scanner dispatch" benchmark compares the two
+			static token_type make_token(rule_id id, std::string_view lexeme, const accumulator& value) {
+
+				// the lexeme may be one of the keywords left out of the dfa
+				if constexpr (automaton_type::num_keywords != 0) {
+					if (automaton_type::hosts_keywords[id])
+						id = automaton_type::keyword_lookup.classify(id, lexeme);
+				}
+
+				return dispatch<num_rules>(id, [&]<size_t Id>() { return make<Id>(lexeme, value); });
+			}
+		};
+
+		reject_type reject_action;
+
+		template <backend Backend = backend::intervals>
+		constexpr auto make_scanner() const {
+
+			if constexpr (Backend == backend::table)
+				return make_table_scanner();
+			else if constexpr (Backend == backend::classes)
+				return make_class_scanner();
+			else if constexpr (Backend == backend::threaded)
+				return make_threaded_scanner();
+			else
+				return make_scanner_impl(
+					std::make_index_sequence<num_states>{}
+				);
+		}
+
+	private:
+		static constexpr const auto& table = automaton_type::table;
+		static constexpr size_t num_states = automaton_type::num_states;
+		static constexpr size_t num_effect_states = automaton_type::num_effect_states;
+
+		using common_type = scanner_common<rules, num_states, num_effect_states>;
+
+		constexpr common_type make_common() const {
+
+			auto result = common_type{ {}, {}, reject_action, automaton_type::loops, automaton_type::ignored_run };
+
+			for (int i = 0; i < num_states; ++i)
+				result.accepts[i] = table.actions[i].value_or(rules::no_rule);
+
+			return result;
+		}
 
 		template <size_t... Is>
 		constexpr auto make_scanner_impl(std::index_sequence<Is...>) const {
 
-			auto dfa = make_dfa();
+			auto result = scanner<rules, num_effect_states, automaton_type::num_trans[Is]...>{ make_common() };
+
+			for (int i = 0; i < num_states; ++i)
+				std::ranges::copy(table.transitions(i), result.transitions[i].begin());
+
+			return result;
+		}
+
+		constexpr auto make_table_scanner() const {
 
-			auto result = scanner<Token, num_trans[Is]...>{};
+			using result_type = table_scanner<rules, num_effect_states, num_states>;
+			using table_state_id = result_type::state_id;
+
+			auto result = result_type{ make_common() };
 
 			for (int i = 0; i < num_states; ++i) {
 
-				const auto& state = dfa.states[i];
+				auto& row = result.next_state[i];
+				row.fill(result_type::rejected);
+
+				for (const auto& [next, input, operation, tags] : table.transitions(i))
+					for (int c = input.min; c <= input.max; ++c) {
+						row[static_cast<unsigned char>(c)] = table_state_id(next);
+						if constexpr (num_effect_states != 0) {
+							if (i < num_effect_states)
+								result.effects[i][static_cast<unsigned char>(c)] = { operation, tags };
+						}
+					}
+			}
 
-				result.actions[i] = (state.action ? *state.action : reject_action);
+			return result;
+		}
 
-				std::copy(state.trans.begin(), state.trans.end(), result.transitions[i].begin());
+		constexpr auto make_class_scanner() const {
+
+			using result_type = class_scanner<rules, num_effect_states, num_states, automaton_type::num_classes>;
+			using table_state_id = result_type::state_id;
+			using class_id = result_type::class_id;
+
+			auto result = result_type{ make_common() };
+
+			for (int c = 0; c < 256; ++c)
+				result.byte_class[c] = class_id(automaton_type::byte_classes[c]);
+
+			for (int i = 0; i < num_states; ++i) {
+
+				auto& row = result.next_state[i];
+				row.fill(result_type::rejected);
+
+				// class boundaries never split an interval, so its ends cover all its classes
+				for (const auto& [next, input, operation, tags] : table.transitions(i)) {
+					auto first = automaton_type::byte_classes[static_cast<unsigned char>(input.min)];
+					auto last = automaton_type::byte_classes[static_cast<unsigned char>(input.max)];
+					for (int k = first; k <= last; ++k) {
+						row[k] = table_state_id(next);
+						if constexpr (num_effect_states != 0) {
+							if (i < num_effect_states)
+								result.effects[i][k] = { operation, tags };
+						}
+					}
+				}
 			}
 
 			return result;
 		}
+
+		constexpr auto make_threaded_scanner() const {
+
+			return threaded_scanner<rules, automaton_type::table, num_effect_states>{ make_common() };
+		}
 	};
 }
@@ -0,0 +1,100 @@
+#include "skip.h"
+
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEXER_SKIP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace lexer::scanner {
+
+	namespace {
+
+		[[maybe_unused]] const char* skip_in_scalar(const char* ptr, const char* limit, const byte_ranges& ranges) {
+
+			while (ptr != limit && ranges.contains(*ptr))
+				++ptr;
+			return ptr;
+		}
+
+		// c is in [min, max] iff c - min <= max - min unsigned, whatever the signedness of char
+		[[maybe_unused]] char width(const fsm::interval& range) {
+
+			return char(std::uint8_t(range.max) - std::uint8_t(range.min));
+		}
+	}
+
+	const char* skip_in(const char* ptr, const char* limit, const byte_ranges& ranges) {
+
+		if (limit && ptr >= limit)
+			return ptr;
+
+#if defined(__AVX2__)
+		using vector = __m256i;
+		constexpr size_t block = 32;
+		static_assert(block <= skip_block);
+
+		vector mins[byte_ranges::max_ranges];
+		vector widths[byte_ranges::max_ranges];
+		for (size_t i = 0; i < ranges.count; ++i) {
+			mins[i] = _mm256_set1_epi8(ranges.ranges[i].min);
+			widths[i] = _mm256_set1_epi8(width(ranges.ranges[i]));
+		}
+
+		// set bits mark the bytes outside the ranges
+		auto outside = [&](const char* base) {
+			auto chunk = _mm256_load_si256(reinterpret_cast<const vector*>(base));
+			auto inside = _mm256_setzero_si256();
+			for (size_t i = 0; i < ranges.count; ++i) {
+				auto shifted = _mm256_sub_epi8(chunk, mins[i]);
+				inside = _mm256_or_si256(inside, _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, widths[i]), shifted));
+			}
+			return ~std::uint32_t(_mm256_movemask_epi8(inside));
+		};
+#elif defined(LEXER_SKIP_SSE2)
+		using vector = __m128i;
+		constexpr size_t block = 16;
+		static_assert(block <= skip_block);
+
+		vector mins[byte_ranges::max_ranges];
+		vector widths[byte_ranges::max_ranges];
+		for (size_t i = 0; i < ranges.count; ++i) {
+			mins[i] = _mm_set1_epi8(ranges.ranges[i].min);
+			widths[i] = _mm_set1_epi8(width(ranges.ranges[i]));
+		}
+
+		// set bits mark the bytes outside the ranges
+		auto outside = [&](const char* base) {
+			auto chunk = _mm_load_si128(reinterpret_cast<const vector*>(base));
+			auto inside = _mm_setzero_si128();
+			for (size_t i = 0; i < ranges.count; ++i) {
+				auto shifted = _mm_sub_epi8(chunk, mins[i]);
+				inside = _mm_or_si128(inside, _mm_cmpeq_epi8(_mm_min_epu8(shifted, widths[i]), shifted));
+			}
+			return ~std::uint32_t(_mm_movemask_epi8(inside)) & 0xffff;
+		};
+#else
+		return skip_in_scalar(ptr, limit, ranges);
+#endif
+
+#if defined(__AVX2__) || defined(LEXER_SKIP_SSE2)
+		// aligned loads never cross into another page, the bytes before ptr in the first block are masked off
+		auto offset = reinterpret_cast<std::uintptr_t>(ptr) % block;
+		auto base = ptr - offset;
+
+		auto mask = outside(base) & (~std::uint32_t(0) << offset);
+		while (!mask) {
+			base += block;
+			if (limit && base >= limit)
+				return limit;
+			mask = outside(base);
+		}
+
+		auto result = base + std::countr_zero(mask);
+		return (limit && result > limit ? limit : result);
+#endif
+	}
+}
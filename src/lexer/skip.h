@@ -0,0 +1,56 @@
+#pragma once
+
+#include "fsm.h"
+
+#include <array>
+#include <span>
+#include <cstdint>
+
+namespace lexer::scanner {
+
+	/// the byte ranges a dfa state loops on, count is 0 if the loop can't be skipped
+	struct byte_ranges {
+
+		static constexpr size_t max_ranges = 4;
+
+		std::array<fsm::interval, max_ranges> ranges = {};
+		std::uint8_t count = 0;
+
+		constexpr bool contains(char c) const {
+
+			for (size_t i = 0; i < count; ++i)
+				if (ranges[i].contains(c))
+					return true;
+			return false;
+		}
+	};
+
+	/// ranges of the transitions of state back to itself, if running through them needs no stepping:
+	/// they have no ops or tags, there are at most max_ranges of them and none takes '\0',
+	/// which ends every unbounded scan
+	constexpr byte_ranges self_loop(std::span<const fsm::transition> transitions, fsm::state_id state) {
+
+		byte_ranges result;
+
+		for (const auto& t : transitions) {
+
+			if (t.next != state)
+				continue;
+
+			if (t.operation != fsm::op::none || t.tags != 0 || t.input.contains('\0') || result.count == byte_ranges::max_ranges)
+				return {};
+
+			result.ranges[result.count++] = t.input;
+		}
+
+		return result;
+	}
+
+	/// widest block skip_in reads at once; blocks are aligned, so the first may start up to skip_block - 1 bytes
+	/// before ptr and the last may end as many bytes past the result or limit, they never cross into another page
+	constexpr size_t skip_block = 32;
+
+	/// first position from ptr on with a byte outside ranges, but at most limit; without a limit the input
+	/// has to contain such a byte; bounded callers need skip_block readable bytes past limit
+	const char* skip_in(const char* ptr, const char* limit, const byte_ranges& ranges);
+}
@@ -0,0 +1,68 @@
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace token {
+
+	symbol symbol_table::intern(std::string_view text) {
+
+		auto hash = std::hash<std::string_view>{}(text);
+		auto shard_index = hash % num_shards;
+		auto& s = shards[shard_index];
+
+		std::scoped_lock lock(s.mutex);
+
+		auto it = s.ids.find(text);
+		if (it == s.ids.end()) {
+			// the key must refer to the stored copy, not the caller's text
+			auto stored = s.store(text);
+			it = s.ids.emplace(stored, std::uint32_t(s.names.size())).first;
+			s.names.push_back(stored);
+		}
+
+		return { std::uint32_t(it->second * num_shards + shard_index) };
+	}
+
+	std::string_view symbol_table::name(symbol sym) const {
+
+		auto& s = shards[sym.id % num_shards];
+
+		std::scoped_lock lock(s.mutex);
+		return s.names[sym.id / num_shards];
+	}
+
+	std::size_t symbol_table::size() const {
+
+		std::size_t result = 0;
+		for (auto& s : shards) {
+			std::scoped_lock lock(s.mutex);
+			result += s.names.size();
+		}
+		return result;
+	}
+
+	std::string_view symbol_table::shard::store(std::string_view text) {
+
+		if (text.empty())
+			return {};
+
+		if (text.size() > chunk_free) {
+			// long names are stored apart so the current chunk is not wasted
+			if (text.size() > chunk_size / 4) {
+				auto* ptr = long_names.emplace_back(std::make_unique<char[]>(text.size())).get();
+				std::ranges::copy(text, ptr);
+				return { ptr, text.size() };
+			}
+
+			chunks.push_back(std::make_unique<char[]>(chunk_size));
+			chunk_free = chunk_size;
+		}
+
+		auto* ptr = chunks.back().get() + (chunk_size - chunk_free);
+		std::ranges::copy(text, ptr);
+		chunk_free -= text.size();
+
+		return { ptr, text.size() };
+	}
+}
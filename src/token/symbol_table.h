@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+namespace token {
+
+	/// interned identifier text, equal text gives equal symbols within one table
+	struct symbol {
+		std::uint32_t id;
+
+		constexpr bool operator==(const symbol&) const = default;
+	};
+
+	/// maps identifier text to symbols, safe to use from many lexing threads at once;
+	/// the text is split by hash over shards, each with its own lock, map and arena for the text,
+	/// a symbol's id is its index within its shard times the shard count plus the shard index,
+	/// so ids are unique but not dense, size() is not a bound on them
+	class symbol_table {
+
+	public:
+
+		symbol intern(std::string_view text);
+
+		/// stays valid as long as the table
+		std::string_view name(symbol s) const;
+
+		std::size_t size() const;
+
+	private:
+
+		static constexpr std::size_t num_shards = 64;
+		static constexpr std::size_t chunk_size = 64 * 1024;
+
+		struct shard {
+
+			mutable std::mutex mutex;
+			std::unordered_map<std::string_view, std::uint32_t> ids;
+			std::vector<std::string_view> names;
+
+			// the text is copied into chunks which are never moved or freed before the table,
+			// the current one is the last
+			std::vector<std::unique_ptr<char[]>> chunks;
+			std::size_t chunk_free = 0;
+
+			// long names, each in an allocation of its own
+			std::vector<std::unique_ptr<char[]>> long_names;
+
+			std::string_view store(std::string_view text);
+		};
+
+		std::array<shard, num_shards> shards;
+	};
+}
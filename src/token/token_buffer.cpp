@@ -0,0 +1,126 @@
+#include "token_buffer.h"
+
+#include <bit>
+#include <array>
+#include <utility>
+
+namespace token {
+
+	void token_buffer::reserve(std::size_t n) {
+
+		kinds_.reserve(n);
+		if (numbers == decoding::lazy)
+			deferred.reserve(n);
+		offsets_.reserve(n);
+		lengths_.reserve(n);
+		payloads_.reserve(n);
+	}
+
+	void token_buffer::push(const token& t, source_span span) {
+
+		kinds_.push_back(kind_type(t.id()));
+		offsets_.push_back(span.offset);
+		lengths_.push_back(span.length);
+
+		if (numbers == decoding::lazy) {
+			// lazy_integer and lazy_float leave the value of the literals they defer at its default,
+			// literals with a value of their own, like nan or a parsed long one, are stored as is;
+			// a literal that really is 0 decodes back to 0
+			bool defer = t.visit(
+				[](const literal<int>& l) { return l.value == 0; },
+				[](const literal<double>& l) { return l.value == 0; },
+				[](const auto&) { return false; }
+			);
+			deferred.push_back(defer);
+			if (defer) {
+				payloads_.push_back(std::uint32_t(decoded.size()));
+				decoded.emplace_back();
+				return;
+			}
+		}
+
+		payloads_.push_back(store_payload(t));
+	}
+
+	std::uint32_t token_buffer::store_payload(const token& t) {
+
+		return t.visit(
+			[](const literal<bool>& l) { return std::uint32_t(l.value); },
+			[](const literal<int>& l) { return std::bit_cast<std::uint32_t>(l.value); },
+			[&](const literal<double>& l) {
+				doubles.push_back(l.value);
+				return std::uint32_t(doubles.size() - 1);
+			},
+			[&](const literal<std::string>& l) {
+				strings.push_back(l.value);
+				return std::uint32_t(strings.size() - 1);
+			},
+			[](const error& e) { return std::uint32_t(e.code); },
+			[](const identifier& i) { return i.name.id; },
+			[](const auto&) { return std::uint32_t(0); }
+		);
+	}
+
+	token token_buffer::decode(std::size_t i, std::string_view lexeme) const {
+
+		bool integer = (kinds_[i] == kind_of<literal<int>>);
+
+		auto& value = decoded[payloads_[i]];
+		if (!value) {
+			auto t = (integer ? integer_parser<token>(lexeme) : float_parser<token>(lexeme));
+
+			// the scan defers only literals in range, so they parse to their own kind
+			value = t.visit(
+				[](const literal<int>& l) { return double(l.value); },
+				[](const literal<double>& l) { return l.value; },
+				[](const auto&) -> double { std::unreachable(); }
+			);
+		}
+
+		if (integer)
+			return literal<int>{ int(*value) };
+		return literal<double>{ *value };
+	}
+
+	template <std::size_t Id>
+	token token_buffer::build(const token_buffer& self, std::size_t i, std::string_view lexeme) {
+
+		using T = token::type_of_id<Id>;
+
+		auto payload = self.payloads_[i];
+
+		if constexpr (std::is_same_v<T, literal<bool>>)
+			return T{ payload != 0 };
+		else if constexpr (std::is_same_v<T, literal<int>>)
+			return T{ std::bit_cast<int>(payload) };
+		else if constexpr (std::is_same_v<T, literal<double>>)
+			return T{ self.doubles[payload] };
+		else if constexpr (std::is_same_v<T, literal<std::string>>)
+			return T{ self.strings[payload] };
+		else if constexpr (std::is_same_v<T, error>)
+			return T{ error::code(payload), std::string(lexeme) };
+		else if constexpr (std::is_same_v<T, identifier>)
+			return T{ symbol{ payload } };
+		else
+			return T{};
+	}
+
+	template <std::size_t... Ids>
+	constexpr auto token_buffer::make_builders(std::index_sequence<Ids...>) {
+		return std::array{
+			&build<Ids>...
+		};
+	}
+
+	token token_buffer::get(std::size_t i, std::string_view source) const {
+
+		static constexpr auto builders = make_builders(std::make_index_sequence<token::count>{});
+
+		auto lexeme = source.substr(offsets_[i], lengths_[i]);
+
+		auto result = (numbers == decoding::lazy && deferred[i] ? decode(i, lexeme) : builders[kinds_[i]](*this, i, lexeme));
+		result.set_span(span(i));
+
+		return result;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "token/tokens.h"
+
+#include "utils/constexpr_utils.h"
+
+#include <vector>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <utility>
+
+namespace token {
+
+	/// tokens of one source as parallel arrays: kind, offset, length and a payload,
+	/// the payload is the value itself where it fits 32 bits, symbols included, or an index into a side table;
+	/// error lexemes are not stored, they are taken from the source when a token is built
+	class token_buffer {
+
+	public:
+
+		using kind_type = uint_for<token::count - 1>;
+
+		template <typename Tk>
+		static constexpr kind_type kind_of = kind_type(token::id_of<Tk>);
+
+		/// lazy buffers take numeric literals undecoded, from the lexer's lazy patterns, and decode one
+		/// on its first get(); the patterns tell out of range literals apart during the scan, so kinds() is final
+		enum class decoding { eager, lazy };
+
+		explicit token_buffer(std::uint16_t file = 0, decoding numbers = decoding::eager) :
+			file(file), numbers(numbers) {}
+
+		decoding number_decoding() const {
+			return numbers;
+		}
+
+		void reserve(std::size_t n);
+
+		void push(const token& t, source_span span);
+
+		std::size_t size() const {
+			return kinds_.size();
+		}
+
+		std::span<const kind_type> kinds() const {
+			return kinds_;
+		}
+
+		std::span<const std::uint32_t> offsets() const {
+			return offsets_;
+		}
+
+		std::span<const std::uint32_t> lengths() const {
+			return lengths_;
+		}
+
+		source_span span(std::size_t i) const {
+			return { .offset = offsets_[i], .length = lengths_[i], .file = file };
+		}
+
+		/// builds the i-th token, source is the one the tokens were scanned from;
+		/// not safe to call from many threads on a lazy buffer
+		token get(std::size_t i, std::string_view source) const;
+
+	private:
+
+		std::uint32_t store_payload(const token& t);
+
+		token decode(std::size_t i, std::string_view lexeme) const;
+
+		template <std::size_t Id>
+		static token build(const token_buffer& self, std::size_t i, std::string_view lexeme);
+
+		template <std::size_t... Ids>
+		static constexpr auto make_builders(std::index_sequence<Ids...>);
+
+		std::vector<kind_type> kinds_;
+		std::vector<std::uint32_t> offsets_;
+		std::vector<std::uint32_t> lengths_;
+		std::vector<std::uint32_t> payloads_;
+
+		// side tables for payloads not fitting in 32 bits
+		std::vector<double> doubles;
+		std::vector<std::string> strings;
+
+		// only for lazy buffers, set for numeric literals pushed without a value,
+		// their payload is their index in decoded
+		std::vector<bool> deferred;
+
+		// the decode cache, values of deferred literals once get() has parsed them, ints are exact in a double
+		mutable std::vector<std::optional<double>> decoded;
+
+		std::uint16_t file;
+		decoding numbers;
+	};
+}
@@ -8,6 +8,7 @@
 
 #include <variant>
 #include <type_traits>
+#include <cstdint>
 
 namespace token {
 
@@ -44,6 +45,15 @@ namespace token {
 		};
 	}
 
+	/// where a token was scanned from, file tells sources apart when there is more than one
+	struct source_span {
+		std::uint32_t offset = 0;
+		std::uint32_t length = 0;
+		std::uint16_t file = 0;
+
+		constexpr bool operator==(const source_span&) const = default;
+	};
+
 	template <typename T>
 	using is_lexeme = detail::is_specialization_of<lexeme, T>;
 
@@ -126,11 +136,18 @@ namespace token {
 		}
 
 		// use lexer to convert into source location
-		std::size_t get_source_offset() const {
-			return source_offset;
+		constexpr source_span get_span() const {
+			return span;
 		}
 
-		constexpr bool operator==(const token_definition& other) const = default;
+		constexpr void set_span(source_span s) {
+			span = s;
+		}
+
+		// the span is not part of the token's value
+		constexpr bool operator==(const token_definition& other) const {
+			return v == other.v;
+		}
 
 		template <typename T>
 			requires (std::is_same_v<T, Tokens> || ...)
@@ -152,7 +169,7 @@ namespace token {
 		static_assert(!duplicate_tokens(token_list::index_sequence));
 
 		std::variant<Tokens...> v;
-		size_t source_offset = 0; // TODO
+		source_span span;
 	};
 }
 
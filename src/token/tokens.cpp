@@ -2,27 +2,147 @@
 
 namespace token {
 
-	token integer_parser(std::string_view lexeme) {
+	symbol_table& symbols() {
+
+		static symbol_table table;
+		return table;
+	}
+
+	identifier make_identifier(std::string_view lexeme) {
+
+		return identifier{ symbols().intern(lexeme) };
+	}
+
+	template <typename Token>
+	Token integer_parser(std::string_view lexeme) {
 
 		int result;
 		auto [ptr, ec] = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), result);
 		assert(ptr == lexeme.data() + lexeme.size());
 
 		if (ec == std::errc::result_out_of_range)
-			return error{ error::integer_literal_out_of_range, std::string(lexeme) };
+			return basic_error<typename Token::text_type>{ error_code::integer_literal_out_of_range, typename Token::text_type(lexeme) };
 
 		return literal<int>{result};
 	}
 
-	token float_parser(std::string_view lexeme) {
+	// the value was built by the scanner while matching pattern::integer_literal
+	template <typename Token>
+	Token integer_value(std::string_view lexeme, const lexer::pattern::accumulator& value) {
+
+		constexpr auto max = std::uint64_t(std::numeric_limits<int>::max());
+
+		if (value.overflow || value.value > max + value.negative)
+			return basic_error<typename Token::text_type>{ error_code::integer_literal_out_of_range, typename Token::text_type(lexeme) };
+
+		auto magnitude = std::int64_t(value.value);
+		return literal<int>{ int(value.negative ? -magnitude : magnitude) };
+	}
+
+	template <typename Token>
+	Token float_parser(std::string_view lexeme) {
 
 		double result;
 		auto [ptr, ec] = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), result);
 		assert(ptr == lexeme.data() + lexeme.size());
 
 		if (ec == std::errc::result_out_of_range)
-			return error{ error::float_literal_out_of_range, std::string(lexeme) };
+			return basic_error<typename Token::text_type>{ error_code::float_literal_out_of_range, typename Token::text_type(lexeme) };
 
 		return literal<double>{result};
 	}
+
+	// the digits before the exponent were accumulated by the scanner and the tags tell where the dot and
+	// the exponent are; if the digits and the power of ten are both exact doubles, so is their quotient
+	// or product (Clinger's fast path), anything else is left to from_chars
+	template <typename Token>
+	Token float_value(std::string_view lexeme, const lexer::pattern::accumulator& value) {
+
+		constexpr double powers_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		constexpr int max_power = int(std::size(powers_of_ten)) - 1;
+		constexpr std::uint64_t max_exact = std::uint64_t(1) << std::numeric_limits<double>::digits;
+
+		auto dot = value.tag(pattern::dot_tag);
+		auto exponent = value.tag(pattern::exponent_tag);
+
+		auto digits_end = exponent.value_or(std::uint32_t(lexeme.size()));
+		int power = (dot ? -int(digits_end - *dot - 1) : 0);
+
+		if (exponent) {
+
+			auto ptr = lexeme.data() + *exponent + 1;
+			auto end = lexeme.data() + lexeme.size();
+			if (*ptr == '+')
+				++ptr;
+
+			// far out of the fast path's range, the bound keeps power from overflowing
+			constexpr int max_exponent = 9999;
+
+			int exponent_value;
+			auto [_, ec] = std::from_chars(ptr, end, exponent_value);
+			if (ec != std::errc{} || exponent_value > max_exponent || exponent_value < -max_exponent)
+				return float_parser<Token>(lexeme);
+
+			power += exponent_value;
+		}
+
+		if (value.overflow || value.value > max_exact || power < -max_power || power > max_power)
+			return float_parser<Token>(lexeme);
+
+		auto result = double(value.value);
+		result = (power < 0 ? result / powers_of_ten[-power] : result * powers_of_ten[power]);
+
+		return literal<double>{ value.negative ? -result : result };
+	}
+
+	// up to digits10 digits always fit
+	template <typename Token>
+	Token lazy_integer(std::string_view lexeme) {
+
+		auto digits = lexeme.size() - (lexeme.front() == '-');
+		if (digits <= std::size_t(std::numeric_limits<int>::digits10))
+			return literal<int>{};
+
+		return integer_parser<Token>(lexeme);
+	}
+
+	// without an exponent, a literal no longer than the decimal exponent range is neither too large
+	// nor too small for a double
+	template <typename Token>
+	Token lazy_float(std::string_view lexeme) {
+
+		if (lexeme.size() <= std::size_t(std::numeric_limits<double>::max_exponent10)
+			&& lexeme.find_first_of("eE") == std::string_view::npos)
+			return literal<double>{};
+
+		return float_parser<Token>(lexeme);
+	}
+
+	template token integer_parser<token>(std::string_view);
+	template token_view integer_parser<token_view>(std::string_view);
+	template token integer_value<token>(std::string_view, const lexer::pattern::accumulator&);
+	template token_view integer_value<token_view>(std::string_view, const lexer::pattern::accumulator&);
+	template token float_parser<token>(std::string_view);
+	template token_view float_parser<token_view>(std::string_view);
+	template token float_value<token>(std::string_view, const lexer::pattern::accumulator&);
+	template token_view float_value<token_view>(std::string_view, const lexer::pattern::accumulator&);
+	template token lazy_integer<token>(std::string_view);
+	template token_view lazy_integer<token_view>(std::string_view);
+	template token lazy_float<token>(std::string_view);
+	template token_view lazy_float<token_view>(std::string_view);
+
+	token token_view::materialize() const {
+
+		token result = visit(
+			[](const error_view& e) -> token { return error{ e.code, std::string(e.lexeme) }; },
+			[](const literal<std::string_view>& l) -> token { return literal<std::string>{ std::string(l.value) }; },
+			[](const auto& t) -> token { return t; }
+		);
+		result.set_span(get_span());
+
+		return result;
+	}
 }
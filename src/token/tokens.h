@@ -1,29 +1,38 @@
 #pragma once
 
 #include "token/token_definition.h"
+#include "token/symbol_table.h"
 
 #include <string>
+#include <string_view>
 #include <charconv>
 #include <cassert>
 #include <limits>
 
 namespace token {
 
-	struct error {
+	enum class error_code {
+		unknown_token,
+		float_literal_out_of_range,
+		integer_literal_out_of_range
+	};
+
+	/// Text is std::string for an owning token, std::string_view for one referring to the source
+	template <typename Text>
+	struct basic_error {
 
-		enum class code {
-			unknown_token,
-			float_literal_out_of_range,
-			integer_literal_out_of_range
-		};
-		using enum code;
+		using code = error_code;
+		using enum error_code;
 
 		code code;
-		std::string lexeme;
+		Text lexeme;
 
-		constexpr bool operator==(const error&) const = default;
+		constexpr bool operator==(const basic_error&) const = default;
 	};
 
+	using error = basic_error<std::string>;
+	using error_view = basic_error<std::string_view>;
+
 	template <typename T>
 	struct literal {
 		T value;
@@ -32,7 +41,7 @@ namespace token {
 	};
 
 	struct identifier {
-		std::string name;
+		symbol name;
 
 		constexpr bool operator==(const identifier&) const = default;
 	};
@@ -41,16 +50,38 @@ namespace token {
 
 		using namespace lexer::pattern;
 
-		constexpr auto integer_literal = (~'-'_p, +digit);
-		constexpr auto exponent = (('e'_p | 'E'_p), ~('-'_p | '+'_p), +digit);
-		constexpr auto float_literal = (~'-'_p, (*digit, '.'_p, +digit, ~exponent) | (+digit, exponent));
+		constexpr auto sign = with_op(op::negate, '-'_p);
+		constexpr auto decimal_digit = with_op(op::decimal_digit, digit);
+
+		// tags of float_literal
+		constexpr tag_id dot_tag = 0;
+		constexpr tag_id exponent_tag = 1;
+
+		constexpr auto exponent_part = (('e'_p | 'E'_p), ~('-'_p | '+'_p), +digit);
+
+		// the scanner accumulates the digits as it goes, see integer_value and float_value
+		constexpr auto integer_literal = (~sign, +decimal_digit);
+		constexpr auto exponent = tagged(exponent_tag, exponent_part);
+		constexpr auto float_literal = (~sign,
+			(*decimal_digit, tagged(dot_tag, '.'_p), +decimal_digit, ~exponent) | (+decimal_digit, exponent));
+
+		// the same lexemes without ops and tags, the scanner only steps through them
+		constexpr auto plain_integer_literal = (~'-'_p, +digit);
+		constexpr auto plain_float_literal = (~'-'_p,
+			(*digit, '.'_p, +digit, ~exponent_part) | (+digit, exponent_part));
 		constexpr auto identifier = (alpha | (('_'_p | alpha), +('_'_p | alpnum)));
+
+		// skipped by the scanner, '\0' ends the input so comments stop there too
+		constexpr auto whitespace = +(' '_p | '\t'_p | '\n'_p | '\r'_p);
+		constexpr auto line_comment = ("//"_p, *(range(-128, -1) | range(1, '\n' - 1) | range('\n' + 1, 127)));
 	}
 
 	using namespace token;
 
-	struct token : token_definition <
-		error,
+	/// tokens whose text payloads are Text
+	template <typename Text>
+	using basic_token = token_definition <
+		basic_error<Text>,
 		eof,
 		op<"+">,
 		op<"-">,
@@ -79,28 +110,80 @@ namespace token {
 		literal<bool>,
 		literal<int>,
 		literal<double>,
-		literal<std::string>,
+		literal<Text>,
 		identifier
-	> {
+	>;
+
+	struct token : basic_token<std::string> {
+		using text_type = std::string;
 		using token_definition::token_definition;
 	};
 
-	token integer_parser(std::string_view lexeme);
-	token float_parser(std::string_view lexeme);
+	/// text payloads refer to the source, which has to outlive the token
+	struct token_view : basic_token<std::string_view> {
+		using text_type = std::string_view;
+		using token_definition::token_definition;
+
+		/// copies the text payloads
+		token materialize() const;
+	};
+
+	/// the table identifiers are interned into by the lexer, shared by the whole process;
+	/// ids depend on the order names were first interned in, so they are stable only within a run
+	symbol_table& symbols();
+
+	identifier make_identifier(std::string_view lexeme);
+
+	// instantiated for token and token_view
+	template <typename Token>
+	Token integer_parser(std::string_view lexeme);
+	template <typename Token>
+	Token integer_value(std::string_view lexeme, const lexer::pattern::accumulator& value);
+	template <typename Token>
+	Token float_parser(std::string_view lexeme);
+	template <typename Token>
+	Token float_value(std::string_view lexeme, const lexer::pattern::accumulator& value);
+
+	// for token_buffer's lazy decoding, the literal with a default value if it is in range for sure,
+	// parsed otherwise so that an out of range one is an error from the scan on
+	template <typename Token>
+	Token lazy_integer(std::string_view lexeme);
+	template <typename Token>
+	Token lazy_float(std::string_view lexeme);
 
 	using lexer::pattern::operator""_p;
 	using lexer::operator>>;
 
-	using custom_patterns = lexer::pattern_action_list<
+	/// the lists differ only in the rules of the numeric literals
+	template <auto IntegerLiteral, auto FloatLiteral>
+	using basic_custom_patterns = lexer::pattern_action_list<
 		("true"_p >> literal<bool>{true}),
 		("false"_p >> literal<bool>{false}),
 		("nan"_p >> literal<double>{ std::numeric_limits<double>::quiet_NaN() }),
 		("inf"_p >> literal<double>{ std::numeric_limits<double>::infinity() }),
 		("-inf"_p >> literal<double>{ -std::numeric_limits<double>::infinity() }),
-		(pattern::integer_literal >> integer_parser),
-		(pattern::float_literal >> float_parser),
-		(pattern::identifier >>
-			[](std::string_view lexeme) { return identifier{ std::string(lexeme) }; })
+		IntegerLiteral,
+		FloatLiteral,
+		(pattern::identifier >> make_identifier),
+		(pattern::whitespace >> lexer::skip),
+		(pattern::line_comment >> lexer::skip)
+	>;
+
+	using custom_patterns = basic_custom_patterns<
+		(pattern::integer_literal >> integer_value<token>),
+		(pattern::float_literal >> float_value<token>)
+	>;
+
+	using custom_patterns_view = basic_custom_patterns<
+		(pattern::integer_literal >> integer_value<token_view>),
+		(pattern::float_literal >> float_value<token_view>)
+	>;
+
+	/// the same but numeric literals in range come out with no value, for token_buffer's lazy decoding;
+	/// their patterns have no ops or tags, so the scanner does not accumulate a value either
+	using custom_patterns_lazy = basic_custom_patterns<
+		(pattern::plain_integer_literal >> lazy_integer<token>),
+		(pattern::plain_float_literal >> lazy_float<token>)
 	>;
 }
 
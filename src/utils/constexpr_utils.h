@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 constexpr void compile_assert(bool test) {
 
@@ -8,3 +11,9 @@ constexpr void compile_assert(bool test) {
 		std::abort();
 }
 
+/// smallest unsigned integer type able to represent values in [0, Max]
+template <std::size_t Max>
+using uint_for = std::conditional_t<(Max <= std::numeric_limits<std::uint8_t>::max()), std::uint8_t,
+	std::conditional_t<(Max <= std::numeric_limits<std::uint16_t>::max()), std::uint16_t,
+	std::conditional_t<(Max <= std::numeric_limits<std::uint32_t>::max()), std::uint32_t,
+	std::uint64_t>>>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#define DISPATCH_CASE(k) \
+	case (k): \
+		if constexpr (Base + (k) < N) \
+			return f.template operator()<Base + (k)>(); \
+		else \
+			std::unreachable();
+
+#define DISPATCH_CASE4(k) DISPATCH_CASE(k) DISPATCH_CASE((k) + 1) DISPATCH_CASE((k) + 2) DISPATCH_CASE((k) + 3)
+#define DISPATCH_CASE16(k) DISPATCH_CASE4(k) DISPATCH_CASE4((k) + 4) DISPATCH_CASE4((k) + 8) DISPATCH_CASE4((k) + 12)
+#define DISPATCH_CASE64(k) DISPATCH_CASE16(k) DISPATCH_CASE16((k) + 16) DISPATCH_CASE16((k) + 32) DISPATCH_CASE16((k) + 48)
+#define DISPATCH_CASE256(k) DISPATCH_CASE64(k) DISPATCH_CASE64((k) + 64) DISPATCH_CASE64((k) + 128) DISPATCH_CASE64((k) + 192)
+
+/// calls f.template operator()<I>() for the runtime index i < N, the index becoming a template argument;
+/// up to 256 indexes are one switch, which compiles to a single jump table, each 256 more add another
+template <std::size_t N, std::size_t Base = 0, typename F>
+constexpr decltype(auto) dispatch(std::size_t i, F&& f) {
+
+	constexpr std::size_t block = 256;
+
+	switch (i - Base) {
+		DISPATCH_CASE256(0)
+	}
+
+	if constexpr (Base + block < N)
+		return dispatch<N, Base + block>(i, f);
+	else
+		std::unreachable();
+}
+
+#undef DISPATCH_CASE256
+#undef DISPATCH_CASE64
+#undef DISPATCH_CASE16
+#undef DISPATCH_CASE4
+#undef DISPATCH_CASE
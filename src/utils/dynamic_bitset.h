@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+
+/// set of indexes in [0, size) with the size chosen at construction, iterates in ascending order
+class dynamic_bitset {
+
+public:
+	using word = std::uint64_t;
+	static constexpr std::size_t word_bits = 64;
+
+	class iterator {
+
+	public:
+		using value_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		constexpr iterator() = default;
+
+		constexpr iterator(const std::vector<word>* words, std::size_t index) :
+			words(words), index(index) {
+
+			if (index < words->size()) {
+				rest = (*words)[index];
+				skip_empty();
+			}
+		}
+
+		constexpr std::size_t operator*() const {
+			return index * word_bits + std::countr_zero(rest);
+		}
+
+		constexpr iterator& operator++() {
+			rest &= rest - 1;
+			skip_empty();
+			return *this;
+		}
+
+		constexpr iterator operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		constexpr bool operator==(const iterator&) const = default;
+
+	private:
+		constexpr void skip_empty() {
+			while (rest == 0 && ++index < words->size())
+				rest = (*words)[index];
+		}
+
+		const std::vector<word>* words = nullptr;
+		std::size_t index = 0;
+		word rest = 0;
+	};
+
+	constexpr dynamic_bitset() = default;
+
+	constexpr explicit dynamic_bitset(std::size_t size) :
+		words((size + word_bits - 1) / word_bits) {}
+
+	constexpr std::size_t capacity() const {
+		return words.size() * word_bits;
+	}
+
+	constexpr bool empty() const {
+		for (auto w : words)
+			if (w)
+				return false;
+		return true;
+	}
+
+	constexpr std::size_t size() const {
+		std::size_t result = 0;
+		for (auto w : words)
+			result += std::popcount(w);
+		return result;
+	}
+
+	constexpr bool contains(std::size_t id) const {
+		return (words[id / word_bits] >> (id % word_bits)) & 1;
+	}
+
+	constexpr void add(std::size_t id) {
+		words[id / word_bits] |= word(1) << (id % word_bits);
+	}
+
+	constexpr void del(std::size_t id) {
+		words[id / word_bits] &= ~(word(1) << (id % word_bits));
+	}
+
+	// both sets must have the same capacity
+	constexpr dynamic_bitset& operator|=(const dynamic_bitset& other) {
+		for (std::size_t i = 0; i < words.size(); ++i)
+			words[i] |= other.words[i];
+		return *this;
+	}
+
+	constexpr iterator begin() const {
+		return iterator(&words, 0);
+	}
+
+	constexpr iterator end() const {
+		return iterator(&words, words.size());
+	}
+
+	// FNV-1a over the words
+	constexpr std::uint64_t hash() const {
+		std::uint64_t result = 14695981039346656037ull;
+		for (auto w : words) {
+			result ^= w;
+			result *= 1099511628211ull;
+		}
+		return result;
+	}
+
+	constexpr auto operator<=>(const dynamic_bitset&) const = default;
+
+private:
+	std::vector<word> words;
+};
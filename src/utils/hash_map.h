@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/// open addressing map, Hash is invoked on keys and yields a 64 bit fingerprint
+/// elements are stored densely and iterate in insertion order, there is no removal
+template <typename K, typename V, auto Hash = &K::hash>
+class hash_map {
+
+public:
+	using value_type = std::pair<K, V>;
+
+	constexpr hash_map() = default;
+
+	constexpr auto begin(this auto& self) {
+		return self.storage.begin();
+	}
+
+	constexpr auto end(this auto& self) {
+		return self.storage.end();
+	}
+
+	constexpr std::size_t size() const {
+		return storage.size();
+	}
+
+	constexpr bool empty() const {
+		return storage.empty();
+	}
+
+	constexpr auto* get(this auto& self, const K& key) {
+		auto [slot, fingerprint] = self.find_slot(key);
+		using result = decltype(&self.storage.front().second);
+		if (self.slots.empty() || self.slots[slot] == empty_slot)
+			return result(nullptr);
+		return &self.storage[self.slots[slot]].second;
+	}
+
+	constexpr bool contains(const K& key) const {
+		return get(key) != nullptr;
+	}
+
+	// does not overwrite, returns the element with the given key
+	constexpr auto add(value_type item) {
+
+		if ((storage.size() + 1) * 4 > slots.size() * 3)
+			grow();
+
+		auto [slot, fingerprint] = find_slot(item.first);
+		if (slots[slot] != empty_slot)
+			return storage.begin() + slots[slot];
+
+		slots[slot] = storage.size();
+		fingerprints.push_back(fingerprint);
+		storage.push_back(std::move(item));
+		return storage.end() - 1;
+	}
+
+	constexpr void reserve(std::size_t count) {
+		storage.reserve(count);
+		fingerprints.reserve(count);
+		while (count * 4 > slots.size() * 3)
+			grow();
+	}
+
+private:
+	static constexpr auto empty_slot = std::size_t(-1);
+
+	// fibonacci hashing, takes the top bits so every bit of the fingerprint matters
+	constexpr std::size_t home_slot(std::uint64_t fingerprint) const {
+		return std::size_t((fingerprint * 11400714819323198485ull) >> (64 - slot_bits));
+	}
+
+	// slot holding key or the empty slot where it would go
+	constexpr std::pair<std::size_t, std::uint64_t> find_slot(const K& key) const {
+
+		std::uint64_t fingerprint = std::invoke(Hash, key);
+		if (slots.empty())
+			return { 0, fingerprint };
+
+		auto mask = slots.size() - 1;
+		for (auto slot = home_slot(fingerprint); ; slot = (slot + 1) & mask) {
+
+			auto index = slots[slot];
+			if (index == empty_slot)
+				return { slot, fingerprint };
+			if (fingerprints[index] == fingerprint && storage[index].first == key)
+				return { slot, fingerprint };
+		}
+	}
+
+	constexpr void grow() {
+
+		slot_bits = (slots.empty() ? 4 : slot_bits + 1);
+		slots.assign(std::size_t(1) << slot_bits, empty_slot);
+
+		auto mask = slots.size() - 1;
+		for (std::size_t index = 0; index < storage.size(); ++index) {
+			auto slot = home_slot(fingerprints[index]);
+			while (slots[slot] != empty_slot)
+				slot = (slot + 1) & mask;
+			slots[slot] = index;
+		}
+	}
+
+	std::vector<value_type> storage;
+	std::vector<std::uint64_t> fingerprints; // parallel to storage
+	std::vector<std::size_t> slots; // indexes into storage
+	unsigned slot_bits = 0;
+};
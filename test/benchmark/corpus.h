@@ -0,0 +1,179 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+namespace corpus {
+
+	/// deterministic mix of lexemes resembling ordinary source code,
+	/// roughly total_bytes long in sum
+	inline std::vector<std::string> lexemes(std::size_t total_bytes) {
+
+		static constexpr std::string_view fixed[] = {
+			"+", "-", "*", "/", "..", "(", ")", "{", "}", "=", ",", "_",
+			"not", "in", "is", "import", "from", "if", "for", "while", "match", "fun", "val", "var",
+			"true", "false", "inf"
+		};
+		static constexpr std::string_view id_head = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+		static constexpr std::string_view id_tail = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+		std::mt19937 rng(2137);
+		auto pick = [&](std::size_t n) { return std::size_t(rng() % n); };
+
+		std::vector<std::string> result;
+		std::size_t size = 0;
+
+		while (size < total_bytes) {
+
+			std::string lexeme;
+
+			auto kind = pick(100);
+
+			if (kind < 45) {
+				lexeme = fixed[pick(std::size(fixed))];
+			} else if (kind < 80) {
+				// identifiers are mostly short with an occasional long one
+				auto length = 1 + pick(8) + (pick(8) == 0 ? pick(24) : 0);
+				lexeme += id_head[pick(id_head.size())];
+				while (lexeme.size() < length)
+					lexeme += id_tail[pick(id_tail.size())];
+			} else if (kind < 95) {
+				auto length = 1 + pick(6);
+				while (lexeme.size() < length)
+					lexeme += char('0' + pick(10));
+			} else {
+				lexeme = std::to_string(pick(1000)) + "." + std::to_string(pick(100000));
+				if (pick(4) == 0)
+					lexeme += "e-" + std::to_string(pick(300));
+			}
+
+			size += lexeme.size();
+			result.push_back(std::move(lexeme));
+		}
+
+		return result;
+	}
+
+	/// integer and float literals only, roughly total_bytes long in sum
+	inline std::vector<std::string> numbers(std::size_t total_bytes) {
+
+		std::mt19937 rng(2137);
+		auto pick = [&](std::size_t n) { return std::size_t(rng() % n); };
+
+		std::vector<std::string> result;
+		std::size_t size = 0;
+
+		while (size < total_bytes) {
+
+			std::string lexeme = std::to_string(pick(1000000));
+			if (pick(2) == 0)
+				lexeme += "." + std::to_string(pick(100000)) + (pick(4) == 0 ? "e-" + std::to_string(pick(300)) : "");
+
+			size += lexeme.size();
+			result.push_back(std::move(lexeme));
+		}
+
+		return result;
+	}
+
+	/// identifiers made of 1 to 4 words, snake_case or camelCase, with word lengths around those
+	/// of English; most are 5 to 20 chars long, roughly total_bytes long in sum
+	inline std::vector<std::string> identifiers(std::size_t total_bytes) {
+
+		static constexpr std::size_t word_lengths[] = { 1, 2, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 7, 7, 8, 9, 10, 12 };
+		static constexpr std::string_view letters = "etaoinshrdlcumwfgypbvkjxqz";
+
+		std::mt19937 rng(2137);
+		auto pick = [&](std::size_t n) { return std::size_t(rng() % n); };
+
+		std::vector<std::string> result;
+		std::size_t size = 0;
+
+		while (size < total_bytes) {
+
+			std::string lexeme;
+
+			auto words = 1 + pick(3) + (pick(6) == 0);
+			bool camel = pick(2) == 0;
+			for (std::size_t w = 0; w < words; ++w) {
+
+				if (w > 0 && !camel)
+					lexeme += '_';
+
+				auto length = word_lengths[pick(std::size(word_lengths))];
+				for (std::size_t i = 0; i < length; ++i) {
+					// skewed towards the frequent letters
+					char c = letters[std::min(pick(letters.size()), pick(letters.size()))];
+					lexeme += (camel && w > 0 && i == 0 ? char(c - 'a' + 'A') : c);
+				}
+			}
+			if (pick(8) == 0)
+				lexeme += char('0' + pick(10));
+
+			size += lexeme.size();
+			result.push_back(std::move(lexeme));
+		}
+
+		return result;
+	}
+
+	/// lexemes laid out as '\n' terminated source lines of a few each, separated by spaces and indented
+	/// by 4 spaces per level of a nesting that wanders between 0 and 8 levels; std::string ends the whole with '\0'
+	inline std::string indented(const std::vector<std::string>& lexemes) {
+
+		std::mt19937 rng(2137);
+		auto pick = [&](std::size_t n) { return std::size_t(rng() % n); };
+
+		std::string result;
+		std::size_t depth = 0;
+		std::size_t on_line = 0;
+		for (auto& lexeme : lexemes) {
+
+			if (on_line == 0) {
+				depth = std::clamp<std::size_t>(depth + pick(3), 1, 9) - 1;
+				result.append(4 * depth, ' ');
+				on_line = 1 + pick(6);
+			}
+			else
+				result += ' ';
+
+			result += lexeme;
+
+			if (--on_line == 0)
+				result += '\n';
+		}
+
+		return result;
+	}
+
+	/// lexemes terminated with '\0' each, suitable for scanning one token per call
+	struct separated {
+
+		std::string text;
+		std::vector<std::size_t> offsets;
+
+		explicit separated(const std::vector<std::string>& lexemes) {
+
+			for (auto& lexeme : lexemes) {
+				offsets.push_back(text.size());
+				text += lexeme;
+				text += '\0';
+			}
+		}
+	};
+
+	/// lexemes joined into one '\0' terminated buffer, separated so that they scan as themselves
+	inline std::string joined(const std::vector<std::string>& lexemes, char separator = ',') {
+
+		std::string result;
+		for (auto& lexeme : lexemes) {
+			result += lexeme;
+			result += separator;
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/lexer.h"
+#include "lexer/scanner.h"
+
+#include "corpus.h"
+#include "scanners.h"
+
+#include <vector>
+
+using scanners::builder;
+
+// run with "[benchmark]"; the corpus is 1 MiB of lexeme text
+TEST_CASE("lexer", "[.][benchmark]") {
+
+	// the backend lexer::lexer uses
+	static constexpr auto scanner = builder.make_scanner();
+
+	const auto input = corpus::joined(corpus::lexemes(1 << 20));
+
+	// tokenize minus filling in the spans
+	BENCHMARK("scan_next, no spans") {
+		std::vector<tk::token> tokens;
+		tokens.reserve(input.size() / 4 + 1);
+		const char* ptr = input.c_str();
+		do
+			tokens.push_back(scanner.scan_next(ptr));
+		while (!tokens.back().is<tk::eof>());
+		return tokens.size();
+	};
+
+	BENCHMARK("tokenize") {
+		return lexer::lexer::tokenize(input).size();
+	};
+
+	BENCHMARK("next") {
+		auto l = lexer::lexer(input);
+		std::size_t count = 1;
+		while (!l.next().is<tk::eof>())
+			++count;
+		return count;
+	};
+}
+
+// run with "[benchmark]"; the corpus is 1 MiB of numeric literals
+TEST_CASE("lexer numbers", "[.][benchmark]") {
+
+	const auto input = corpus::joined(corpus::numbers(1 << 20));
+
+	BENCHMARK("token_buffer, eager") {
+		auto buffer = tk::token_buffer();
+		lexer::lexer::tokenize(input, buffer);
+		return buffer.size();
+	};
+
+	BENCHMARK("token_buffer, lazy") {
+		auto buffer = tk::token_buffer(0, tk::token_buffer::decoding::lazy);
+		lexer::lexer::tokenize(input, buffer);
+		return buffer.size();
+	};
+
+	// every value is needed in the end
+	BENCHMARK("token_buffer, lazy, all decoded") {
+		auto buffer = tk::token_buffer(0, tk::token_buffer::decoding::lazy);
+		lexer::lexer::tokenize(input, buffer);
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < buffer.size(); ++i)
+			sum += buffer.get(i, input).id();
+		return sum;
+	};
+}
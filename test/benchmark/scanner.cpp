@@ -0,0 +1,241 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/scanner.h"
+#include "token/tokens.h"
+
+#include "corpus.h"
+#include "scanners.h"
+
+#include <array>
+#include <string>
+#include <utility>
+
+using lexer::scanner::backend;
+using scanners::builder;
+using scanners::reject;
+using scanners::scan_all;
+
+// run with "[benchmark]"; the corpus is 1 MiB of lexeme text
+TEST_CASE("scanner backends", "[.][benchmark]") {
+
+	static constexpr auto intervals = builder.make_scanner<backend::intervals>();
+	static constexpr auto table = builder.make_scanner<backend::table>();
+	static constexpr auto classes = builder.make_scanner<backend::classes>();
+	static constexpr auto threaded = builder.make_scanner<backend::threaded>();
+
+	const auto input = corpus::separated(corpus::lexemes(1 << 20));
+
+	BENCHMARK("intervals") {
+		return scan_all(intervals, input);
+	};
+
+	BENCHMARK("table") {
+		return scan_all(table, input);
+	};
+
+	BENCHMARK("classes") {
+		return scan_all(classes, input);
+	};
+
+	// only clang guarantees tail calls, with MSVC the unbounded scan goes through the switch too
+#ifdef LEXER_MUSTTAIL
+	const auto threaded_name = std::string("threaded, tail calls");
+#else
+	const auto threaded_name = std::string("threaded, switch");
+#endif
+
+	BENCHMARK(threaded_name) {
+		return scan_all(threaded, input);
+	};
+
+	// bounded scans never tail call, the threaded scanner steps through its flat switch over the states;
+	// each lexeme ends at its terminator and the padding follows the last one
+	const auto padded = input.text + std::string(lexer::scanner::scanner_base::padding, ' ');
+
+	auto scan_all_bounded = [&](const auto& scanner) {
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < input.offsets.size(); ++i) {
+			auto end = i + 1 < input.offsets.size() ? input.offsets[i + 1] - 1 : input.text.size() - 1;
+			sum += scanner.scan(padded.data() + input.offsets[i], padded.data() + end).id();
+		}
+		return sum;
+	};
+
+	BENCHMARK("intervals bounded") {
+		return scan_all_bounded(intervals);
+	};
+
+	BENCHMARK("threaded bounded, switch") {
+		return scan_all_bounded(threaded);
+	};
+}
+
+// the same rules, but every token costs an indirect call like the per state function pointers did
+template <typename Rules>
+struct indirect_rules : Rules {
+
+	static Rules::token_type make_token(Rules::rule_id id, std::string_view lexeme, const lexer::scanner::accumulator& value) {
+		return thunks[id](lexeme, value);
+	}
+
+	static constexpr auto thunks = []<std::size_t... Is>(std::index_sequence<Is...>) {
+		return std::array{ &Rules::template make<Is>... };
+	}(std::make_index_sequence<Rules::num_rules>{});
+};
+
+template <typename Rules, std::size_t NumEffectStates, std::size_t NumStates>
+static auto with_indirect_rules(const lexer::scanner::table_scanner<Rules, NumEffectStates, NumStates>& scanner) {
+	return lexer::scanner::table_scanner<indirect_rules<Rules>, NumEffectStates, NumStates>{
+		{ {}, scanner.accepts, scanner.reject_action, scanner.loops, scanner.ignored_run }, scanner.next_state, scanner.effects
+	};
+}
+
+// run with "[benchmark]"; tokens/s is the token count in the names over the mean time
+TEST_CASE("scanner dispatch", "[.][benchmark]") {
+
+	static constexpr auto switched = builder.make_scanner<backend::table>();
+	static const auto indirect = with_indirect_rules(switched);
+
+	const auto input = corpus::separated(corpus::lexemes(1 << 20));
+	const auto count = std::to_string(input.offsets.size()) + " tokens";
+
+	BENCHMARK("switch on rule id, " + count) {
+		return scan_all(switched, input);
+	};
+
+	BENCHMARK("function pointer per rule, " + count) {
+		return scan_all(indirect, input);
+	};
+}
+
+// run with "[benchmark]"; the corpus is 1 MiB of identifiers
+TEST_CASE("scanner self loops", "[.][benchmark]") {
+
+	static constexpr auto skipping = builder.make_scanner<backend::table>();
+
+	// the same scanner stepping through every byte
+	static const auto stepping = [] {
+		auto result = skipping;
+		result.loops.fill({});
+		return result;
+	}();
+
+	const auto input = corpus::joined(corpus::identifiers(1 << 20));
+
+	BENCHMARK("skipping loops") {
+		return scan_all(skipping, input);
+	};
+
+	BENCHMARK("stepping") {
+		return scan_all(stepping, input);
+	};
+}
+
+// run with "[benchmark]"; the corpus is about 1 MiB of lexemes on indented lines
+TEST_CASE("scanner whitespace", "[.][benchmark]") {
+
+	static constexpr auto skipping = builder.make_scanner<backend::table>();
+
+	// without the run skipped at token boundaries, whitespace is still skipped once its state loops
+	static const auto looping = [] {
+		auto result = skipping;
+		result.ignored_run = {};
+		return result;
+	}();
+
+	static const auto stepping = [] {
+		auto result = looping;
+		result.loops.fill({});
+		return result;
+	}();
+
+	const auto input = corpus::indented(corpus::lexemes(1 << 20));
+
+	BENCHMARK("skipping runs at boundaries") {
+		return scan_all(skipping, input);
+	};
+
+	BENCHMARK("skipping loops") {
+		return scan_all(looping, input);
+	};
+
+	BENCHMARK("stepping") {
+		return scan_all(stepping, input);
+	};
+}
+
+// run with "[benchmark]"; the corpus is 1 MiB of lexeme text, the names give the dfa states
+// and the size of each scanner's tables
+TEST_CASE("scanner keywords", "[.][benchmark]") {
+
+	static constexpr auto hashed_builder = lexer::scanner::builder<tk::token, tk::custom_patterns,
+		lexer::scanner::construction::thompson, lexer::scanner::keywords::hashed>{ .reject_action = reject };
+
+	static constexpr auto in_dfa = builder.make_scanner<backend::table>();
+	static constexpr auto hashed = hashed_builder.make_scanner<backend::table>();
+
+	const auto input = corpus::separated(corpus::lexemes(1 << 20));
+
+	auto describe = [](const auto& scanner) {
+		return std::to_string(scanner.num_states) + " states, " + std::to_string(sizeof(scanner)) + " bytes";
+	};
+
+	BENCHMARK("keywords in the dfa, " + describe(in_dfa)) {
+		return scan_all(in_dfa, input);
+	};
+
+	BENCHMARK("hashed keywords, " + describe(hashed)) {
+		return scan_all(hashed, input);
+	};
+}
+
+// the numeric patterns with the ops and tags their values are accumulated by and without any,
+// the actions ignore the value so only the scan loop differs
+using lexer::operator>>;
+
+using patterns_with_effects = lexer::pattern_action_list<
+	(tk::pattern::integer_literal >> tk::literal<int>{}),
+	(tk::pattern::float_literal >> tk::literal<double>{}),
+	(tk::pattern::identifier >> tk::make_identifier),
+	(tk::pattern::whitespace >> lexer::skip)
+>;
+
+using patterns_without_effects = lexer::pattern_action_list<
+	(tk::pattern::plain_integer_literal >> tk::literal<int>{}),
+	(tk::pattern::plain_float_literal >> tk::literal<double>{}),
+	(tk::pattern::identifier >> tk::make_identifier),
+	(tk::pattern::whitespace >> lexer::skip)
+>;
+
+// run with "[benchmark]"; 1 MiB of numbers, where every transition has effects, and 1 MiB of lexemes,
+// where few have; the names give the states with effects
+TEST_CASE("scanner effects", "[.][benchmark]") {
+
+	static constexpr auto with_effects = lexer::scanner::builder<tk::token, patterns_with_effects>{ .reject_action = reject }
+		.make_scanner<backend::table>();
+	static constexpr auto without_effects = lexer::scanner::builder<tk::token, patterns_without_effects>{ .reject_action = reject }
+		.make_scanner<backend::table>();
+
+	const auto numbers = corpus::separated(corpus::numbers(1 << 20));
+	const auto lexemes = corpus::separated(corpus::lexemes(1 << 20));
+
+	auto describe = [](const auto& scanner) {
+		return std::to_string(scanner.num_effect_states) + " of " + std::to_string(scanner.num_states) + " states";
+	};
+
+	BENCHMARK("numbers with effects, " + describe(with_effects)) {
+		return scan_all(with_effects, numbers);
+	};
+
+	BENCHMARK("numbers without effects, " + describe(without_effects)) {
+		return scan_all(without_effects, numbers);
+	};
+
+	BENCHMARK("lexemes with effects") {
+		return scan_all(with_effects, lexemes);
+	};
+
+	BENCHMARK("lexemes without effects") {
+		return scan_all(without_effects, lexemes);
+	};
+}
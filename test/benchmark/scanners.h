@@ -0,0 +1,35 @@
+#pragma once
+
+#include "lexer/scanner.h"
+#include "token/tokens.h"
+
+#include "corpus.h"
+
+#include <string>
+#include <string_view>
+
+namespace scanners {
+
+	inline tk::token reject(std::string_view lexeme) {
+		return tk::error{ tk::error::unknown_token, std::string(lexeme) };
+	}
+
+	inline constexpr auto builder = lexer::scanner::builder<tk::token, tk::custom_patterns>{ .reject_action = reject };
+
+	/// scans each lexeme on its own, from its offset to its terminator
+	std::size_t scan_all(const auto& scanner, const corpus::separated& input) {
+		std::size_t sum = 0;
+		for (auto offset : input.offsets)
+			sum += scanner.scan(input.text.data() + offset).id();
+		return sum;
+	}
+
+	/// scans the text token after token up to eof
+	std::size_t scan_all(const auto& scanner, const std::string& input) {
+		std::size_t sum = 0;
+		const char* ptr = input.c_str();
+		for (auto token = scanner.scan_next(ptr); !token.is<tk::eof>(); token = scanner.scan_next(ptr))
+			sum += token.id();
+		return sum;
+	}
+}
@@ -1,4 +1,5 @@
 #include "lexer/fsm.h"
+#include "utils/constexpr_utils.h"
 
 #include <catch2/catch_amalgamated.hpp>
 
@@ -39,3 +40,225 @@ TEST_CASE("lexer::fsm") {
 	//REQUIRE(sc.scan("-2.5") == 1);
 	//REQUIRE(sc.scan("0.0") == 1);
 }*/
+
+using action = int (*)(std::string_view);
+
+static consteval void compile_time_tests() {
+
+	constexpr action reject = [](std::string_view) { return 0; };
+	constexpr action accept_a = [](std::string_view) { return 1; };
+	constexpr action accept_b = [](std::string_view) { return 2; };
+
+	{ // equivalent states are merged
+		auto n = nfa<action>::from_pattern(('a'_p | 'b'_p, *('a'_p | 'b'_p)));
+		n.states.back().action = accept_a;
+
+		auto raw = dfa<action>::from_nfa(n);
+		raw.reject_action = reject;
+
+		auto min = raw.minimize();
+		compile_assert(raw.states.size() > 2);
+		compile_assert(min.states.size() == 2);
+		compile_assert(min.scan("abba") == 1);
+		compile_assert(min.scan("") == 0);
+		compile_assert(min.scan("c") == 0);
+	}
+
+	{ // distinct actions are kept apart
+		auto a = nfa<action>::from_pattern(('x'_p, 'a'_p));
+		a.states.back().action = accept_a;
+		auto b = nfa<action>::from_pattern(('x'_p, 'b'_p));
+		b.states.back().action = accept_b;
+
+		auto raw = dfa<action>::from_nfa(merge_nfas<action>(std::vector{ std::move(a), std::move(b) }));
+		raw.reject_action = reject;
+
+		auto min = raw.minimize();
+		compile_assert(min.states.size() == 4);
+		compile_assert(min.scan("xa") == 1);
+		compile_assert(min.scan("xb") == 2);
+		compile_assert(min.scan("x") == 0);
+	}
+}
+
+TEST_CASE("lexer::fsm::dfa::minimize") {
+
+	compile_time_tests();
+}
+
+static consteval void partition_tests() {
+
+	{ // overlapping and duplicate inputs
+		auto parts = partition_inputs({ { 'a', 'z' }, { 'a', 'a' }, { 'c', 'f' }, { 'a', 'z' } });
+		compile_assert(parts.size() == 4);
+		compile_assert(parts[0].input == interval{ 'a', 'a' } && parts[0].sources.size() == 3);
+		compile_assert(parts[1].input == interval{ 'b', 'b' } && parts[1].sources.size() == 2);
+		compile_assert(parts[2].input == interval{ 'c', 'f' } && parts[2].sources.size() == 3);
+		compile_assert(parts[3].input == interval{ 'g', 'z' } && parts[3].sources.size() == 2);
+	}
+
+	{ // gaps are not covered, the whole char range is handled
+		auto parts = partition_inputs({ { 'x', 'y' }, { 'a', 'b' }, { 'y', char(127) } });
+		compile_assert(parts.size() == 4);
+		compile_assert(parts[0].input == interval{ 'a', 'b' } && parts[0].sources == std::vector<size_t>{ 1 });
+		compile_assert(parts[1].input == interval{ 'x', 'x' });
+		compile_assert(parts[2].input == interval{ 'y', 'y' } && parts[2].sources.size() == 2);
+		compile_assert(parts[3].input == interval{ 'z', char(127) });
+	}
+}
+
+TEST_CASE("lexer::fsm::partition_inputs") {
+
+	partition_tests();
+}
+
+static consteval void glushkov_tests() {
+
+	constexpr action reject = [](std::string_view) { return 0; };
+	constexpr action accept = [](std::string_view) { return 1; };
+
+	constexpr auto p = ('-'_p | '+'_p, times<1, 3>('0'_p | '1'_p), *('_'_p, '0'_p), at_least<2>('x'_p));
+
+	auto glushkov = nfa<action>::from_pattern_glushkov(p, accept);
+
+	// one state per char position plus the initial
+	compile_assert(glushkov.states.size() == 1 + 2 + 3 * 2 + 2 + 2 * 1);
+	for (auto& state : glushkov.states)
+		compile_assert(state.eps_trans.empty());
+
+	auto thompson = nfa<action>::from_pattern(p);
+	thompson.states.back().action = accept;
+
+	auto g = dfa<action>::from_nfa(glushkov).minimize();
+	g.reject_action = reject;
+	auto t = dfa<action>::from_nfa(thompson).minimize();
+	t.reject_action = reject;
+
+	compile_assert(g.states.size() == t.states.size());
+
+	for (auto input : { "", "-", "+0xx", "-101xx", "-1011xx", "+1_0_0xx", "+1_xx", "-0xxxx", "-0x" })
+		compile_assert(g.scan(input) == t.scan(input));
+
+	{ // nullable pattern accepts at the initial state
+		auto n = nfa<action>::from_pattern_glushkov(*'a'_p, accept);
+		auto d = dfa<action>::from_nfa(n);
+		d.reject_action = reject;
+		compile_assert(d.scan("") == 1);
+		compile_assert(d.scan("aa") == 1);
+	}
+}
+
+TEST_CASE("lexer::fsm::nfa::from_pattern_glushkov") {
+
+	glushkov_tests();
+}
+
+static consteval void table_tests() {
+
+	constexpr action accept = [](std::string_view) { return 1; };
+
+	auto n = nfa<action>::from_pattern(('a'_p, *'b'_p));
+	n.states.back().action = accept;
+
+	auto d = dfa<action>::from_nfa(n).minimize();
+	auto table = dfa_table<action, 8, 8>::from_dfa(d);
+
+	compile_assert(table.num_states == d.states.size());
+	for (state_id id = 0; id < table.num_states; ++id) {
+		compile_assert(table.actions[id] == d.states[id].action);
+		compile_assert(std::ranges::equal(table.transitions(id), d.states[id].trans,
+			[](auto& l, auto& r) { return l.next == r.next && l.input == r.input; }));
+	}
+}
+
+TEST_CASE("lexer::fsm::dfa_table") {
+
+	table_tests();
+}
+
+// runs the ops and marks the tags along input, which the dfa must not reject
+static consteval accumulator accumulate(const dfa<action>& d, std::string_view input) {
+
+	accumulator value;
+	state_id current = 0;
+	for (std::uint32_t offset = 0; offset < input.size(); ++offset) {
+		char c = input[offset];
+		auto it = std::ranges::find_if(d.states[current].trans, [c](auto& t) { return t.input.contains(c); });
+		value.apply(it->operation, it->tags, c, offset);
+		current = it->next;
+	}
+	return value;
+}
+
+static consteval void op_tests() {
+
+	constexpr action accept = [](std::string_view) { return 1; };
+
+	constexpr auto p = (~with_op(op::negate, '-'_p), +with_op(op::decimal_digit, digit), ~'x'_p);
+
+	auto thompson = nfa<action>::from_pattern(p);
+	thompson.states.back().action = accept;
+
+	auto t = dfa<action>::from_nfa(thompson).minimize();
+	auto g = dfa<action>::from_nfa(nfa<action>::from_pattern_glushkov(p, accept)).minimize();
+
+	for (auto& d : { t, g }) {
+		auto negative = accumulate(d, "-120x");
+		compile_assert(negative.value == 120 && negative.negative && !negative.overflow);
+		compile_assert(accumulate(d, "0042").value == 42);
+		compile_assert(accumulate(d, "18446744073709551615").value == std::numeric_limits<std::uint64_t>::max());
+		compile_assert(accumulate(d, "18446744073709551616").overflow);
+	}
+
+	{ // transitions with different ops to the same state stay apart
+		auto n = nfa<action>::from_pattern(('a'_p, 'c'_p) | (with_op(op::decimal_digit, 'b'_p), 'c'_p));
+		n.states.back().action = accept;
+		auto d = dfa<action>::from_nfa(n).minimize();
+
+		compile_assert(d.states[0].trans.size() == 2);
+		compile_assert(d.states[0].trans[0].operation != d.states[0].trans[1].operation);
+	}
+}
+
+TEST_CASE("lexer::fsm ops") {
+
+	op_tests();
+}
+
+static consteval void tag_tests() {
+
+	constexpr action accept = [](std::string_view) { return 1; };
+
+	// a tag marks where its pattern starts, later chars of the pattern don't move it
+	constexpr auto p = (*'a'_p, ~tagged(0, ('b'_p, *'a'_p)), tagged(1, *'c'_p), 'd'_p);
+
+	auto thompson = nfa<action>::from_pattern(p);
+	thompson.states.back().action = accept;
+
+	auto t = dfa<action>::from_nfa(thompson).minimize();
+	auto g = dfa<action>::from_nfa(nfa<action>::from_pattern_glushkov(p, accept)).minimize();
+
+	for (auto& d : { t, g }) {
+
+		auto both = accumulate(d, "aabaaccd");
+		compile_assert(both.tag(0) == 2u);
+		compile_assert(both.tag(1) == 5u);
+
+		auto none = accumulate(d, "aad");
+		compile_assert(!none.tag(0) && !none.tag(1));
+
+		compile_assert(accumulate(d, "cd").tag(1) == 0u);
+
+		// the states with effects are numbered right after the initial one
+		auto has_effects = [](auto& state) {
+			return std::ranges::any_of(state.trans, [](auto& t) { return t.operation != op::none || t.tags != 0; });
+		};
+		for (size_t id = 2; id < d.states.size(); ++id)
+			compile_assert(!has_effects(d.states[id]) || has_effects(d.states[id - 1]));
+	}
+}
+
+TEST_CASE("lexer::fsm tags") {
+
+	tag_tests();
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/keywords.h"
+#include "lexer/pattern.h"
+#include "utils/constexpr_utils.h"
+
+#include <array>
+#include <string_view>
+
+using table = lexer::scanner::keyword_table<int, 32, 6>;
+
+static constexpr int identifier = 100;
+static constexpr int other = 101;
+
+static constexpr std::string_view words[] = {
+	"not", "in", "is", "import", "from", "if", "for", "while", "match", "fun", "val", "var", "true", "false", "nan", "inf"
+};
+
+static constexpr auto keywords = [] {
+
+	std::array<table::entry, std::size(words)> entries;
+	for (int i = 0; i < int(std::size(words)); ++i)
+		entries[i] = { .text = words[i], .rule = i, .host = identifier };
+
+	return table::build(entries);
+}();
+
+static consteval void classify_tests() {
+
+	for (int i = 0; i < int(std::size(words)); ++i)
+		compile_assert(keywords.classify(identifier, words[i]) == i);
+
+	compile_assert(keywords.classify(identifier, "imports") == identifier);
+	compile_assert(keywords.classify(identifier, "iffy") == identifier);
+	compile_assert(keywords.classify(identifier, "nat") == identifier);
+	compile_assert(keywords.classify(identifier, "x") == identifier);
+	compile_assert(keywords.classify(identifier, "") == identifier);
+	compile_assert(keywords.classify(identifier, "whiles") == identifier);
+
+	// only lexemes of the host are keywords
+	compile_assert(keywords.classify(other, "import") == other);
+}
+
+static consteval void exact_string_tests() {
+
+	using namespace lexer::pattern;
+
+	compile_assert(exact_string(('i'_p, 'f'_p)) == "if");
+	compile_assert(exact_string('+'_p) == "+");
+	compile_assert(!exact_string(+'a'_p));
+	compile_assert(!exact_string(('a'_p, digit)));
+	compile_assert(!exact_string('a'_p | 'b'_p));
+}
+
+TEST_CASE("lexer::scanner::keyword_table") {
+
+	classify_tests();
+	exact_string_tests();
+
+	// the same at run time, where the compare is a memcmp
+	for (int i = 0; i < int(std::size(words)); ++i)
+		REQUIRE(keywords.classify(identifier, words[i]) == i);
+
+	REQUIRE(keywords.classify(identifier, "imports") == identifier);
+}
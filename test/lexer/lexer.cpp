@@ -3,6 +3,8 @@
 #include "lexer/lexer.h"
 
 #include <cmath>
+#include <string>
+#include <vector>
 
 using namespace tk;
 
@@ -54,8 +56,121 @@ TEST_CASE("lexer::lexer") {
 		REQUIRE(std::isnan(d->value));
 		REQUIRE(l.scan("inf") == literal<double>{std::numeric_limits<double>::infinity()});
 		REQUIRE(l.scan("-inf") == literal<double>{-std::numeric_limits<double>::infinity()});
-		REQUIRE(l.scan("falsely") == identifier{ "falsely" });
-		REQUIRE(l.scan("xxx") == identifier{ "xxx" });
-		REQUIRE(l.scan("iffy") == identifier{ "iffy" });
+		REQUIRE(l.scan("falsely") == identifier{ symbols().intern("falsely") });
+		REQUIRE(l.scan("xxx") == identifier{ symbols().intern("xxx") });
+		REQUIRE(l.scan("iffy") == identifier{ symbols().intern("iffy") });
+		REQUIRE(l.scan("1..5") == literal<int>{1});
+	}
+
+	SECTION("next") {
+
+		auto source = std::string("x=1..5");
+		auto cursor = lexer::lexer(source);
+
+		REQUIRE(cursor.peek() == identifier{ symbols().intern("x") });
+		REQUIRE(cursor.next() == identifier{ symbols().intern("x") });
+		REQUIRE(cursor.next() == sym<"=">{});
+		REQUIRE(cursor.peek() == literal<int>{1});
+		REQUIRE(cursor.peek() == literal<int>{1});
+		REQUIRE(cursor.next() == literal<int>{1});
+		REQUIRE(cursor.next() == op<"..">{});
+		REQUIRE(cursor.next() == literal<int>{5});
+		REQUIRE(cursor.next() == eof{});
+		REQUIRE(cursor.next() == eof{});
+
+		// no source
+		REQUIRE(l.peek() == eof{});
+		REQUIRE(l.next() == eof{});
+		REQUIRE(l.next() == eof{});
+	}
+
+	SECTION("tokenize") {
+
+		auto tokens = lexer::lexer::tokenize(std::string("fun(a,-2.5e1)"));
+
+		REQUIRE(tokens == std::vector<tk::token>{
+			keyword<"fun">{}, sym<"(">{}, identifier{ symbols().intern("a") }, sym<",">{}, literal<double>{-25.0}, sym<")">{}, eof{}
+		});
+
+		REQUIRE(lexer::lexer::tokenize("") == std::vector<tk::token>{ eof{} });
+	}
+
+	SECTION("tokenize_view") {
+
+		auto source = std::string("x=@1..99999999999");
+		auto views = lexer::lexer::tokenize_view(source);
+		auto tokens = lexer::lexer::tokenize(source);
+
+		REQUIRE(views.size() == tokens.size());
+
+		// the error lexemes point into the source
+		auto* error = views[2].get_if<error_view>();
+		REQUIRE(error);
+		REQUIRE(error->lexeme.data() == source.data() + 2);
+		REQUIRE(views[5].get_if<error_view>()->code == error::integer_literal_out_of_range);
+
+		for (std::size_t i = 0; i < views.size(); ++i) {
+			auto owned = views[i].materialize();
+			REQUIRE(owned == tokens[i]);
+			REQUIRE(owned.get_span() == tokens[i].get_span());
+		}
+	}
+
+	SECTION("spans") {
+
+		auto source = std::string("if(x1,-2.5)@");
+		auto tokens = lexer::lexer::tokenize(source, 3);
+
+		auto spans = std::vector<source_span>();
+		for (auto& t : tokens)
+			spans.push_back(t.get_span());
+
+		REQUIRE(spans == std::vector<source_span>{
+			{ 0, 2, 3 }, { 2, 1, 3 }, { 3, 2, 3 }, { 5, 1, 3 }, { 6, 4, 3 }, { 10, 1, 3 }, { 11, 1, 3 }, { 12, 0, 3 }
+		});
+
+		auto cursor = lexer::lexer(source, 3);
+		for (auto& span : spans)
+			REQUIRE(cursor.next().get_span() == span);
+	}
+
+	SECTION("whitespace and comments") {
+
+		auto source = std::string("  x = 1 // one\n\ty");
+		auto tokens = lexer::lexer::tokenize(source);
+
+		REQUIRE(tokens == std::vector<tk::token>{
+			identifier{ symbols().intern("x") }, sym<"=">{}, literal<int>{1}, identifier{ symbols().intern("y") }, eof{}
+		});
+
+		auto spans = std::vector<source_span>();
+		for (auto& t : tokens)
+			spans.push_back(t.get_span());
+
+		REQUIRE(spans == std::vector<source_span>{ { 2, 1, 0 }, { 4, 1, 0 }, { 6, 1, 0 }, { 16, 1, 0 }, { 17, 0, 0 } });
+
+		auto cursor = lexer::lexer(source);
+		for (auto& span : spans)
+			REQUIRE(cursor.next().get_span() == span);
+
+		// trailing whitespace leaves only the eof
+		auto padded = source + "  " + std::string(lexer::lexer::padding, ' ');
+		auto bounded = lexer::lexer::tokenize_bounded(std::string_view(padded).substr(0, source.size() + 2));
+		REQUIRE(bounded == tokens);
+		REQUIRE(bounded.back().get_span() == source_span{ 19, 0, 0 });
+	}
+
+	SECTION("tokenize_bounded") {
+
+		// a view into the middle of a larger buffer with a '\0' inside
+		auto buffer = std::string("xx(1..2") + '\0' + "in)yy" + std::string(lexer::lexer::padding, 'z');
+		auto source = std::string_view(buffer).substr(2, 9);
+
+		REQUIRE(lexer::lexer::tokenize_bounded(source) == std::vector<tk::token>{
+			sym<"(">{}, literal<int>{1}, op<"..">{}, literal<int>{2}, error{ error::unknown_token, std::string(1, '\0') },
+			keyword<"in">{}, sym<")">{}, eof{}
+		});
+
+		REQUIRE(lexer::lexer::tokenize_bounded(source.substr(0, 0)) == std::vector<tk::token>{ eof{} });
 	}
 }
@@ -0,0 +1,47 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/line_index.h"
+
+#include <string>
+#include <vector>
+
+using lexer::line_index;
+
+TEST_CASE("lexer::line_index") {
+
+	SECTION("locate") {
+
+		auto source = std::string("ab\ncd\n\nefgh");
+		auto index = line_index(source);
+
+		REQUIRE(index.locate(0) == line_index::location{ 1, 1 });
+		REQUIRE(index.locate(2) == line_index::location{ 1, 3 });
+		REQUIRE(index.locate(3) == line_index::location{ 2, 1 });
+		REQUIRE(index.locate(6) == line_index::location{ 3, 1 });
+		REQUIRE(index.locate(9) == line_index::location{ 4, 3 });
+		REQUIRE(index.locate(11) == line_index::location{ 4, 5 });
+		REQUIRE(index.line_count() == 4);
+
+		REQUIRE(line_index("").locate(0) == line_index::location{ 1, 1 });
+	}
+
+	SECTION("find_line_starts") {
+
+		// lengths around the vector widths, newlines at every position in a block
+		auto length = GENERATE(range(0, 100));
+
+		std::string source;
+		std::vector<std::uint32_t> expected;
+		for (int i = 0; i < length; ++i) {
+			bool newline = (i * 7 + length) % 5 == 0;
+			source += (newline ? '\n' : char('a' + i % 26));
+			if (newline)
+				expected.push_back(i + 1);
+		}
+
+		std::vector<std::uint32_t> starts;
+		lexer::find_line_starts(source, starts);
+
+		REQUIRE(starts == expected);
+	}
+}
@@ -1,7 +1,317 @@
 #include <catch2/catch_amalgamated.hpp>
 
 #include "lexer/scanner.h"
+#include "token/tokens.h"
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <charconv>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+using lexer::scanner::backend;
+using lexer::scanner::construction;
+using lexer::scanner::keywords;
+
+static tk::token reject(std::string_view lexeme) {
+	return tk::error{ tk::error::unknown_token, std::string(lexeme) };
+}
+
+static constexpr auto builder = lexer::scanner::builder<tk::token, tk::custom_patterns>{ .reject_action = reject };
 
 TEST_CASE("lexer::scanner") {
 
+	static constexpr auto reference = builder.make_scanner<backend::intervals>();
+
+	auto input = GENERATE(as<std::string>{},
+		"", "+", "-", "..", ".", "1.", "1..5", "(", "_", "_x", "x_1",
+		"in", "inf", "-inf", "-in", "iffy", "import", "imported",
+		"0", "-23", "02137", "2147483647", "2147483648", "-2147483648", "-2147483649", "1e1", "2e+2", "10E-3", "1e", "1.5", "-02.3", ".5",
+		"true", "falsely", "@", "\x80", "a\xff",
+		" ", "  x", "\t\r\n1", "x  y", "/", "/ /", "//", "// c\n-", "1//c", "\n\n    @"
+	);
+
+	SECTION("table") {
+
+		static constexpr auto scanner = builder.make_scanner<backend::table>();
+
+		REQUIRE(scanner.scan(input.c_str()) == reference.scan(input.c_str()));
+	}
+
+	SECTION("classes") {
+
+		static constexpr auto scanner = builder.make_scanner<backend::classes>();
+
+		REQUIRE(scanner.scan(input.c_str()) == reference.scan(input.c_str()));
+	}
+
+	SECTION("threaded") {
+
+		static constexpr auto scanner = builder.make_scanner<backend::threaded>();
+
+		REQUIRE(scanner.scan(input.c_str()) == reference.scan(input.c_str()));
+
+		// the switch driven path the bounded scan takes
+		auto padded = input + std::string(scanner.padding, 'x');
+		const char* ptr = padded.c_str();
+
+		REQUIRE(scanner.scan(ptr, ptr + input.size()) == reference.scan(input.c_str()));
+	}
+
+	SECTION("bounded") {
+
+		// the padding would extend most lexemes if it were scanned
+		auto padded = input + std::string(reference.padding, 'x');
+		const char* ptr = padded.c_str();
+
+		REQUIRE(reference.scan(ptr, ptr + input.size()) == reference.scan(input.c_str()));
+	}
+
+	SECTION("glushkov") {
+
+		static constexpr auto glushkov_builder =
+			lexer::scanner::builder<tk::token, tk::custom_patterns, construction::glushkov>{ .reject_action = reject };
+		static constexpr auto scanner = glushkov_builder.make_scanner<backend::intervals>();
+
+		REQUIRE(scanner.scan(input.c_str()) == reference.scan(input.c_str()));
+	}
+}
+
+TEST_CASE("lexer::scanner::scan_next") {
+
+	static constexpr auto scanner = builder.make_scanner<backend::table>();
+
+	SECTION("rolls back to the last accepting state") {
+
+		const char* ptr = "1..5";
+
+		REQUIRE(scanner.scan_next(ptr) == tk::literal<int>{ 1 });
+		REQUIRE(scanner.scan_next(ptr) == tk::op<"..">{});
+		REQUIRE(scanner.scan_next(ptr) == tk::literal<int>{ 5 });
+		REQUIRE(scanner.scan_next(ptr) == tk::eof{});
+	}
+
+	SECTION("values come from the rolled back lexeme") {
+
+		const char* ptr = "1.5e-";
+
+		REQUIRE(scanner.scan_next(ptr) == tk::literal<double>{ 1.5 });
+		REQUIRE(scanner.scan_next(ptr) == tk::identifier{ tk::symbols().intern("e") });
+	}
+
+	SECTION("skips whitespace and comments") {
+
+		const char* ptr = "  fun // c\n\t(x)  ";
+
+		REQUIRE(scanner.scan_next(ptr) == tk::keyword<"fun">{});
+		REQUIRE(scanner.scan_next(ptr) == tk::sym<"(">{});
+		REQUIRE(scanner.scan_next(ptr) == tk::identifier{ tk::symbols().intern("x") });
+		REQUIRE(scanner.scan_next(ptr) == tk::sym<")">{});
+		REQUIRE(scanner.scan_next(ptr) == tk::eof{});
+	}
+
+	SECTION("the lexeme starts past the skipped ones") {
+
+		const char* input = " 1 //c\n  +";
+		const char* ptr = input;
+
+		REQUIRE(scanner.ignored_run.contains(' '));
+
+		auto [one, one_lexeme] = scanner.scan_lexeme(ptr);
+		REQUIRE(one == tk::literal<int>{ 1 });
+		REQUIRE(one_lexeme.data() == input + 1);
+		REQUIRE(one_lexeme == "1");
+
+		auto [plus, plus_lexeme] = scanner.scan_lexeme(ptr);
+		REQUIRE(plus == tk::op<"+">{});
+		REQUIRE(plus_lexeme.data() == input + 9);
+		REQUIRE(ptr == input + 10);
+	}
+
+	SECTION("bounded scans skip up to the end") {
+
+		auto padded = std::string("x  ") + std::string(scanner.padding, ' ');
+		const char* ptr = padded.c_str();
+		const char* end = ptr + 3;
+
+		REQUIRE(scanner.scan_next(ptr, end) == tk::identifier{ tk::symbols().intern("x") });
+		REQUIRE(scanner.scan_next(ptr, end) == tk::eof{});
+		REQUIRE(ptr == end);
+	}
+
+	SECTION("bounded scans reject an embedded terminator") {
+
+		auto padded = std::string("1\0+", 3) + std::string(scanner.padding, 'x');
+		const char* ptr = padded.c_str();
+		const char* end = ptr + 3;
+
+		REQUIRE(scanner.scan_next(ptr, end) == tk::literal<int>{ 1 });
+		REQUIRE(scanner.scan_next(ptr, end) == tk::error{ tk::error::unknown_token, std::string(1, '\0') });
+		REQUIRE(scanner.scan_next(ptr, end) == tk::op<"+">{});
+		REQUIRE(scanner.scan_next(ptr, end) == tk::eof{});
+	}
+
+	SECTION("rejects a single char") {
+
+		const char* ptr = "@1";
+
+		REQUIRE(scanner.scan_next(ptr) == tk::error{ tk::error::unknown_token, "@" });
+		REQUIRE(scanner.scan_next(ptr) == tk::literal<int>{ 1 });
+	}
+
+	SECTION("memoized failures give the same tokens") {
+
+		std::string input;
+		for (int i = 0; i < 100; ++i)
+			input += "1.e1..2-.5x1e+";
+
+		auto memo = lexer::scanner::failure_memo(input.data(), input.data() + input.size(), scanner.num_states);
+
+		const char* ptr = input.data();
+		const char* memo_ptr = input.data();
+		while (true) {
+			auto expected = scanner.scan_next(ptr);
+			REQUIRE(scanner.scan_next(memo_ptr, memo) == expected);
+			REQUIRE(memo_ptr == ptr);
+			if (expected.is<tk::eof>())
+				break;
+		}
+	}
+}
+
+// counts the dfa steps of the scans, skipped runs take none
+template <typename Scanner>
+struct counting_scanner : Scanner {
+
+	mutable std::size_t steps = 0;
+
+	constexpr auto step(typename Scanner::state_id current, char c, std::uint32_t offset, lexer::scanner::accumulator& value) const {
+		++steps;
+		return Scanner::step(current, c, offset, value);
+	}
+};
+
+TEST_CASE("lexer::scanner::failure_memo") {
+
+	using namespace lexer::pattern;
+	using lexer::operator>>;
+
+	// a run of x is rejected from every position in it, after looping to its end
+	static constexpr auto rollback_builder = lexer::scanner::builder<tk::token, lexer::pattern_action_list<
+		((+'x'_p, '!'_p) >> tk::literal<int>{})
+	>>{ .reject_action = reject };
+
+	static constexpr auto scanner = rollback_builder.make_scanner<backend::table>();
+
+	REQUIRE(std::ranges::any_of(scanner.loops, [](const auto& loop) { return loop.contains('x'); }));
+
+	const auto input = std::string(4096, 'x');
+
+	auto counting = counting_scanner<std::remove_cvref_t<decltype(scanner)>>{ scanner };
+	auto memo = lexer::scanner::failure_memo(input.data(), input.data() + input.size(), scanner.num_states);
+
+	const char* ptr = input.data();
+
+	// the run is stepped through instead of skipped, so the memo holds every position in it
+	REQUIRE(counting.scan_next(ptr, memo) == tk::error{ tk::error::unknown_token, "x" });
+	REQUIRE(counting.steps >= input.size());
+
+	// and every later scan stops one step into it
+	while (!counting.scan_next(ptr, memo).is<tk::eof>()) {}
+	REQUIRE(counting.steps <= 2 * input.size() + 2);
+}
+
+TEST_CASE("lexer::scanner hashed keywords") {
+
+	static constexpr auto hashed_builder =
+		lexer::scanner::builder<tk::token, tk::custom_patterns, construction::thompson, keywords::hashed>{ .reject_action = reject };
+
+	static constexpr auto reference = builder.make_scanner<backend::table>();
+	static constexpr auto scanner = hashed_builder.make_scanner<backend::table>();
+	static constexpr auto threaded = hashed_builder.make_scanner<backend::threaded>();
+
+	// the keywords no longer have paths of their own
+	STATIC_REQUIRE(scanner.num_states < reference.num_states);
+
+	auto input = GENERATE(as<std::string>{},
+		"not", "in", "is", "import", "from", "if", "for", "while", "match", "fun", "val", "var",
+		"true", "false", "nan", "inf", "-inf", "-in", "imported", "iffy", "falsely", "i", "_", "_if", "if_", "x",
+		"if x in y", "fun(x)=import  // for\nwhile", ""
+	);
+
+	std::vector<tk::token> expected;
+	std::vector<tk::token> tokens;
+	std::vector<tk::token> threaded_tokens;
+
+	const char* ptr = input.c_str();
+	const char* hashed_ptr = input.c_str();
+	const char* threaded_ptr = input.c_str();
+	do {
+		expected.push_back(reference.scan_next(ptr));
+		tokens.push_back(scanner.scan_next(hashed_ptr));
+		threaded_tokens.push_back(threaded.scan_next(threaded_ptr));
+	} while (!expected.back().is<tk::eof>());
+
+	REQUIRE(tokens == expected);
+	REQUIRE(threaded_tokens == expected);
+}
+
+TEST_CASE("lexer::scanner integer values") {
+
+	static constexpr auto scanner = builder.make_scanner<backend::classes>();
+
+	auto scan = [](const char* input) { return scanner.scan(input); };
+	auto out_of_range = [](const char* input) { return tk::token(tk::error{ tk::error::integer_literal_out_of_range, input }); };
+
+	REQUIRE(scan("0") == tk::literal<int>{ 0 });
+	REQUIRE(scan("-0") == tk::literal<int>{ 0 });
+	REQUIRE(scan("007") == tk::literal<int>{ 7 });
+	REQUIRE(scan("2147483647") == tk::literal<int>{ 2147483647 });
+	REQUIRE(scan("-2147483648") == tk::literal<int>{ std::numeric_limits<int>::min() });
+	REQUIRE(scan("2147483648") == out_of_range("2147483648"));
+	REQUIRE(scan("-2147483649") == out_of_range("-2147483649"));
+	REQUIRE(scan("99999999999999999999999") == out_of_range("99999999999999999999999"));
+}
+
+TEST_CASE("lexer::scanner float values") {
+
+	static constexpr auto scanner = builder.make_scanner<backend::table>();
+
+	// the fast path has to agree with from_chars whether it is taken or not
+	std::string input = GENERATE(as<std::string>{},
+		"1.5", "-02.3", ".5", "0.1", "-0.0", "1e5", "2e+2", "10E-3", "-1.25e-3", "1e-22", "1e23",
+		"3.14159265358979", "9007199254740993.0", "123456789012345678901.5", "1.7976931348623157e308", "5e-324"
+	);
+
+	double expected;
+	std::from_chars(input.data(), input.data() + input.size(), expected);
+
+	auto result = scanner.scan(input.c_str());
+	REQUIRE(result.is<tk::literal<double>>());
+	REQUIRE(std::signbit(result.get_if<tk::literal<double>>()->value) == std::signbit(expected));
+	REQUIRE(result == tk::literal<double>{ expected });
+}
+
+TEST_CASE("lexer::scanner::stream_scanner") {
+
+	static constexpr auto scanner = builder.make_scanner<backend::classes>();
+
+	const auto input = std::string("fun(x, y) = import-1..-2.5e+3@iffy,inf * nan/false // end\n  x");
+
+	std::vector<tk::token> expected;
+	for (const char* ptr = input.c_str(); expected.empty() || !expected.back().is<tk::eof>(); )
+		expected.push_back(scanner.scan_next(ptr));
+
+	auto chunk_size = GENERATE(size_t(1), size_t(2), size_t(5), size_t(1000));
+
+	auto stream = lexer::scanner::stream_scanner(scanner);
+
+	std::vector<tk::token> tokens;
+	for (size_t offset = 0; offset < input.size(); offset += chunk_size)
+		stream.feed(std::string_view(input).substr(offset, chunk_size), tokens);
+	stream.finish(tokens);
+
+	REQUIRE(tokens == expected);
 }
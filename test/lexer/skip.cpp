@@ -0,0 +1,83 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/skip.h"
+#include "utils/constexpr_utils.h"
+
+#include <string>
+#include <vector>
+
+using lexer::scanner::byte_ranges;
+using lexer::fsm::transition;
+using lexer::fsm::op;
+
+static consteval void self_loop_tests() {
+
+	using lexer::scanner::self_loop;
+
+	std::vector<transition> trans = {
+		{ .next = 1, .input = { '0', '9' } },
+		{ .next = 2, .input = { 'A', 'Z' } },
+		{ .next = 1, .input = { '_', '_' } },
+		{ .next = 3, .input = { 'a', 'z' } },
+	};
+
+	auto loop = self_loop(trans, 1);
+	compile_assert(loop.count == 2);
+	compile_assert(loop.contains('5') && loop.contains('_') && !loop.contains('a'));
+
+	compile_assert(self_loop(trans, 0).count == 0);
+
+	// the loop has to run without stepping
+	trans[2].operation = op::decimal_digit;
+	compile_assert(self_loop(trans, 1).count == 0);
+	trans[2].operation = op::none;
+
+	trans[0].input = { '\0', '9' };
+	compile_assert(self_loop(trans, 1).count == 0);
+}
+
+TEST_CASE("lexer::scanner::self_loop") {
+
+	self_loop_tests();
+}
+
+TEST_CASE("lexer::scanner::skip_in") {
+
+	byte_ranges identifier;
+	identifier.ranges = { { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } } };
+	identifier.count = 4;
+
+	byte_ranges high;
+	high.ranges[0] = { char(0x80), char(0xff) };
+	high.count = 1;
+
+	auto scalar = [](const char* ptr, const char* limit, const byte_ranges& ranges) {
+		while (ptr != limit && ranges.contains(*ptr))
+			++ptr;
+		return ptr;
+	};
+
+	// runs ending at every position within and across the vector widths, from every alignment
+	auto length = GENERATE(range(0, 80));
+	auto start = GENERATE(range(0, 33));
+
+	for (const auto* ranges : { &identifier, &high }) {
+
+		auto member = (ranges == &identifier ? 'x' : char(0xc4));
+
+		std::string source(start, member);
+		source += std::string(length, member);
+		source += '!';
+		source += std::string(64, member);
+		source += '\0';
+
+		const char* ptr = source.data() + start;
+
+		REQUIRE(lexer::scanner::skip_in(ptr, nullptr, *ranges) == ptr + length);
+
+		for (auto limit : { 0, length / 2, length + 1, length + 40 }) {
+			const char* end = ptr + limit;
+			REQUIRE(lexer::scanner::skip_in(ptr, end, *ranges) == scalar(ptr, end, *ranges));
+		}
+	}
+}
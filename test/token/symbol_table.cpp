@@ -0,0 +1,60 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "token/symbol_table.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+
+using token::symbol, token::symbol_table;
+
+TEST_CASE("token::symbol_table") {
+
+	SECTION("intern") {
+
+		symbol_table table;
+
+		auto text = std::string("abc");
+		auto a = table.intern(text);
+		text = "xyz";
+
+		REQUIRE(table.intern("abc") == a);
+		REQUIRE(table.intern("xyz") != a);
+		REQUIRE(table.name(a) == "abc");
+
+		auto long_name = std::string(100000, 'q');
+		auto q = table.intern(long_name);
+		REQUIRE(table.name(q) == long_name);
+		REQUIRE(table.name(table.intern("abd")) == "abd");
+
+		REQUIRE(table.size() == 4);
+	}
+
+	SECTION("parallel") {
+
+		symbol_table table;
+
+		constexpr int num_threads = 8;
+		constexpr int num_names = 4096;
+
+		// every thread interns the same names in a different order
+		std::vector<std::vector<symbol>> results(num_threads, std::vector<symbol>(num_names));
+		std::vector<std::thread> threads;
+		for (int t = 0; t < num_threads; ++t) {
+			threads.emplace_back([&, t] {
+				for (int i = 0; i < num_names; ++i) {
+					auto n = (i * (2 * t + 1)) % num_names;
+					results[t][n] = table.intern("name" + std::to_string(n));
+				}
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+
+		REQUIRE(table.size() == num_names);
+		for (int t = 1; t < num_threads; ++t)
+			REQUIRE(results[t] == results[0]);
+		for (int n = 0; n < num_names; ++n)
+			REQUIRE(table.name(results[0][n]) == "name" + std::to_string(n));
+	}
+}
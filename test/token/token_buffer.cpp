@@ -0,0 +1,60 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "lexer/lexer.h"
+#include "token/token_buffer.h"
+
+#include <string>
+#include <vector>
+
+using namespace tk;
+
+TEST_CASE("token::token_buffer") {
+
+	auto source = std::string("fun f(x)=if x in 1..-20 {2.5e3,true,@,x_y}");
+
+	auto expected = lexer::lexer::tokenize(source, 7);
+
+	auto buffer = token_buffer(7);
+	lexer::lexer::tokenize(source, buffer);
+
+	REQUIRE(buffer.size() == expected.size());
+
+	for (std::size_t i = 0; i < buffer.size(); ++i) {
+		REQUIRE(buffer.kinds()[i] == expected[i].id());
+		REQUIRE(buffer.span(i) == expected[i].get_span());
+
+		auto t = buffer.get(i, source);
+		REQUIRE(t == expected[i]);
+		REQUIRE(t.get_span() == expected[i].get_span());
+	}
+
+	REQUIRE(buffer.kinds()[0] == token_buffer::kind_of<keyword<"fun">>);
+	REQUIRE(buffer.kinds().back() == token_buffer::kind_of<eof>);
+}
+
+TEST_CASE("token::token_buffer lazy") {
+
+	auto source = std::string("x=1..-20,2.5e3,99999999999,1e999,-inf");
+
+	auto expected = lexer::lexer::tokenize(source);
+
+	auto buffer = token_buffer(0, token_buffer::decoding::lazy);
+	lexer::lexer::tokenize(source, buffer);
+
+	REQUIRE(buffer.size() == expected.size());
+
+	// out of range literals are errors before anything is decoded
+	REQUIRE(buffer.kinds()[8] == token_buffer::kind_of<error>);
+	REQUIRE(buffer.kinds()[10] == token_buffer::kind_of<error>);
+
+	for (std::size_t i = 0; i < buffer.size(); ++i)
+		REQUIRE(buffer.kinds()[i] == expected[i].id());
+
+	for (std::size_t i = 0; i < buffer.size(); ++i) {
+		REQUIRE(buffer.get(i, source) == expected[i]);
+		REQUIRE(buffer.kinds()[i] == expected[i].id());
+
+		// decoded once, the cached value is used from then on
+		REQUIRE(buffer.get(i, source) == expected[i]);
+	}
+}
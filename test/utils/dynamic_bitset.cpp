@@ -0,0 +1,77 @@
+#include "utils/dynamic_bitset.h"
+#include "utils/constexpr_utils.h"
+
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+
+static consteval void compile_time_tests() {
+
+	{ // ctors
+		dynamic_bitset def;
+		compile_assert(def.empty());
+		compile_assert(def.capacity() == 0);
+
+		dynamic_bitset s(130);
+		compile_assert(s.empty());
+		compile_assert(s.capacity() >= 130);
+		compile_assert(s.begin() == s.end());
+	}
+
+	{ // add/del
+		dynamic_bitset s(130);
+		s.add(0);
+		s.add(64);
+		s.add(129);
+		compile_assert(s.size() == 3);
+		compile_assert(s.contains(0));
+		compile_assert(s.contains(64));
+		compile_assert(s.contains(129));
+		compile_assert(!s.contains(1));
+		compile_assert(!s.contains(63));
+		s.del(64);
+		compile_assert(s.size() == 2);
+		compile_assert(!s.contains(64));
+		s.del(0);
+		s.del(129);
+		compile_assert(s.empty());
+	}
+
+	{ // union and iteration order
+		dynamic_bitset a(200), b(200);
+		a.add(150);
+		a.add(3);
+		b.add(70);
+		b.add(3);
+		a |= b;
+
+		std::vector<std::size_t> ids;
+		for (auto id : a)
+			ids.push_back(id);
+		compile_assert(ids == std::vector<std::size_t>{ 3, 70, 150 });
+	}
+
+	{ // comparison
+		dynamic_bitset a(10), b(10);
+		compile_assert(a == b);
+		a.add(5);
+		compile_assert(a != b);
+		b.add(5);
+		compile_assert(a == b);
+		b.add(1);
+		compile_assert(a < b || b < a);
+	}
+}
+
+TEST_CASE("dynamic_bitset") {
+
+	compile_time_tests();
+
+	dynamic_bitset s(100);
+	s.add(99);
+	s.add(0);
+	REQUIRE(s.size() == 2);
+
+	std::vector<std::size_t> ids(s.begin(), s.end());
+	REQUIRE(ids == std::vector<std::size_t>{ 0, 99 });
+}
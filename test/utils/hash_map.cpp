@@ -0,0 +1,74 @@
+#include "utils/hash_map.h"
+#include "utils/constexpr_utils.h"
+
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cstdint>
+
+namespace {
+
+	struct key {
+
+		int value;
+
+		// deliberately poor, forces probing
+		constexpr std::uint64_t hash() const {
+			return std::uint64_t(value % 3);
+		}
+
+		constexpr bool operator==(const key&) const = default;
+	};
+}
+
+static consteval void compile_time_tests() {
+
+	{ // ctors
+		hash_map<key, int> def;
+		compile_assert(def.empty());
+		compile_assert(def.get({ 0 }) == nullptr);
+	}
+
+	{ // add
+		hash_map<key, int> m;
+		m.add({ { 1 }, 1 });
+		compile_assert(m.size() == 1);
+		compile_assert(m.contains({ 1 }));
+		compile_assert(!m.contains({ 4 }));
+
+		auto it = m.add({ { 1 }, 5 });
+		compile_assert(m.size() == 1);
+		compile_assert(it->second == 1);
+		compile_assert(*m.get({ 1 }) == 1);
+	}
+
+	{ // growth keeps every element and the insertion order
+		hash_map<key, int> m;
+		for (int i = 0; i < 100; ++i)
+			m.add({ { i }, i * 2 });
+
+		compile_assert(m.size() == 100);
+		for (int i = 0; i < 100; ++i)
+			compile_assert(*m.get({ i }) == i * 2);
+		compile_assert(m.get({ 100 }) == nullptr);
+
+		int expected = 0;
+		for (auto& [k, v] : m)
+			compile_assert(k.value == expected++);
+	}
+}
+
+TEST_CASE("hash_map") {
+
+	compile_time_tests();
+
+	hash_map<key, int> m;
+	m.reserve(10);
+	for (int i = 0; i < 10; ++i)
+		m.add({ { i }, i });
+
+	REQUIRE(m.size() == 10);
+	REQUIRE(*m.get({ 7 }) == 7);
+	*m.get({ 7 }) = 8;
+	REQUIRE(*m.get({ 7 }) == 8);
+	REQUIRE(!m.contains({ 10 }));
+}